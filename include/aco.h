@@ -0,0 +1,108 @@
+// Jacob Matchuny
+// TSP solver
+// Ant colony header
+
+// Multiple inclusion protection
+#ifndef ACO_H
+#define ACO_H
+
+// Extern includes
+#include <vector>
+#include <random>
+#include <functional>
+
+// Includes from this project
+#include "spatialgrid.h"
+
+// Ant - per task tour building state
+struct Ant
+{
+    // City ids in tour order
+    std::vector<unsigned int> order;
+
+    // Visited stamp per city id (equal to stamp means visited)
+    std::vector<unsigned int> seen;
+    unsigned int stamp;
+
+    // Fallback search over unvisited cities
+    SpatialGrid grid;
+
+    // Thread random numbers
+    std::mt19937 rng;
+
+    // Best tour this thread built in the current iteration
+    std::vector<unsigned int> best;
+    float bestCost;
+
+    // Selection weights scratch
+    std::vector<double> weights;
+};
+
+// AntColony - MAX-MIN Ant System with pheromone kept only on the k-nearest
+// candidate edges. Ants build tours in parallel, each pool task keeps its own
+// iteration best and the colony merges them and deposits after the join.
+class AntColony
+{
+    public:
+        // Constructor (xs, ys, candidate lists, candidates per city)
+        AntColony(const std::vector<float>&, const std::vector<float>&, const std::vector<unsigned int>&, unsigned int);
+
+        // Run from a first best tour until maxIterations or stop(best tour, cost) is true, returns best tour
+        std::vector<unsigned int> run(const std::vector<unsigned int>&, const std::function<bool(const std::vector<unsigned int>&, float)>&);
+
+        // Ants per iteration
+        unsigned int ants;
+
+        // Parallel tasks (pool size by default)
+        unsigned int threads;
+
+        // Iteration cap
+        unsigned int maxIterations;
+
+        // Pheromone and distance exponents
+        double alpha, beta;
+
+        // Evaporation rate
+        double rho;
+
+        // Chance the converged colony rebuilds the best tour (sets the trail floor)
+        double pBest;
+
+        // Base seed
+        unsigned int seed;
+
+        // Iterations done in the last run
+        unsigned int iterations;
+
+        // Best tour cost from the last run
+        float bestCost;
+
+    private:
+        // Problem
+        const std::vector<float>& xs;
+        const std::vector<float>& ys;
+        const std::vector<unsigned int>& candidates;
+        unsigned int k;
+        unsigned int n;
+
+        // Pheromone per candidate slot, and tau^alpha * eta^beta for selection
+        std::vector<double> trail;
+        std::vector<double> choice;
+
+        // Trail limits
+        double trailMax, trailMin;
+
+        // Distance between ids
+        float dist(unsigned int, unsigned int) const;
+
+        // Build one tour into ant.order and return its cost
+        float buildTour(Ant&);
+
+        // Add pheromone on every edge of a tour
+        void deposit(const std::vector<unsigned int>&, double);
+
+        // Evaporate, clamp and refresh selection weights
+        void update(const std::vector<unsigned int>&, float);
+};
+
+#endif // ACO_H
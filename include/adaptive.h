@@ -0,0 +1,56 @@
+// Jacob Matchuny
+// TSP solver
+// Adaptive operator selection header
+
+// Multiple inclusion protection
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+// Extern includes
+#include <vector>
+#include <random>
+
+// OperatorSelector - adaptive pursuit over a set of operators (Thierens).
+// Each operator keeps a running quality from the rewards it earns; after
+// every reward the best operator's pick probability is pulled toward pMax
+// and every other one toward pMin, so the operator that currently pays off
+// gets most of the picks while the rest still get tried now and then.
+class OperatorSelector
+{
+    public:
+        // Constructor (operators, probability floor, quality rate, pursuit rate)
+        OperatorSelector(unsigned int = 0, double = 0.1, double = 0.3, double = 0.3);
+
+        // Operator index drawn by probability
+        unsigned int pick(std::mt19937&);
+
+        // Reward earned by an operator (0 = no gain)
+        void reward(unsigned int, double);
+
+        // Pick probability of an operator
+        double probability(unsigned int) const;
+
+        // Operators
+        unsigned int size() const;
+
+        // Uses, quality and probability of every operator, for checkpoints
+        std::vector<double> save() const;
+
+        // Put back a save(), false if it holds another operator count
+        bool load(const std::vector<double>&);
+
+        // Rewards given per operator, one per finished use
+        std::vector<unsigned long> uses;
+
+    private:
+        // Running reward and pick probability per operator
+        std::vector<double> quality, chance;
+
+        // Floor / ceiling of the pick probability
+        double pMin, pMax;
+
+        // Quality and probability learning rates
+        double alpha, beta;
+};
+
+#endif // ADAPTIVE_H
@@ -0,0 +1,108 @@
+// Jacob Matchuny
+// TSP solver
+// Simulated annealing header
+
+// Multiple inclusion protection
+#ifndef ANNEAL_H
+#define ANNEAL_H
+
+// Extern includes
+#include <vector>
+#include <random>
+#include <functional>
+
+// Replica - one annealing chain (permutation tour plus positions)
+struct Replica
+{
+    // City ids in tour order
+    std::vector<unsigned int> order;
+
+    // Position of each city id in order
+    std::vector<unsigned int> pos;
+
+    // Tour length
+    double cost;
+
+    // Current temperature
+    double temp;
+
+    // Chain random numbers
+    std::mt19937 rng;
+
+    // Moves tried / taken
+    long moves, accepted;
+
+    // Rotation scratch
+    std::vector<unsigned int> scratch;
+};
+
+// Annealer - simulated annealing on a permutation tour with candidate list
+// 2-opt and or-opt moves (O(1) deltas) and parallel tempering: one replica
+// per pool task on a geometric temperature ladder, neighbours swap states
+// between sweeps
+class Annealer
+{
+    public:
+        // Constructor (xs, ys, candidate lists, candidates per city)
+        Annealer(const std::vector<float>&, const std::vector<float>&, const std::vector<unsigned int>&, unsigned int);
+
+        // Anneal from a tour until frozen or stop(best tour, cost) is true, returns best tour
+        std::vector<unsigned int> run(const std::vector<unsigned int>&, const std::function<bool(const std::vector<unsigned int>&, float)>&);
+
+        // Number of replicas (threads)
+        unsigned int replicas;
+
+        // Hottest start temperature, in units of the mean tour edge
+        double startTemp;
+
+        // Ladder multiplier per sweep
+        double cooling;
+
+        // Coldest temperature relative to hottest on the ladder
+        double ladder;
+
+        // Moves per replica between exchanges, in units of n
+        double sweep;
+
+        // Base seed
+        unsigned int seed;
+
+        // Totals from the last run
+        long moves, accepted, exchanges, swaps;
+        unsigned int rounds;
+        float bestCost;
+
+    private:
+        // Problem
+        const std::vector<float>& xs;
+        const std::vector<float>& ys;
+        const std::vector<unsigned int>& candidates;
+        unsigned int k;
+        unsigned int n;
+
+        // Distance between ids
+        double dist(unsigned int, unsigned int) const;
+
+        // Exact tour length
+        double length(const Replica&) const;
+
+        // Metropolis test
+        bool accept(Replica&, double);
+
+        // One random move
+        void step(Replica&);
+
+        // Try 2-opt move joining a and c
+        void twoOpt(Replica&, unsigned int, unsigned int, bool);
+
+        // Try moving the segment starting at a next to c
+        void orOpt(Replica&, unsigned int, unsigned int, unsigned int);
+
+        // Reverse tour path between positions i and j (forward, inclusive)
+        void reverse(Replica&, unsigned int, unsigned int);
+
+        // Rotate positions start..start+total left by shift
+        void rotate(Replica&, unsigned int, unsigned int, unsigned int);
+};
+
+#endif // ANNEAL_H
@@ -0,0 +1,124 @@
+// Jacob Matchuny
+// TSP solver
+// Arena header
+
+// Multiple inclusion protection
+#ifndef ARENA_H
+#define ARENA_H
+
+// Includes from this project
+#include "link.h"
+
+// Extern includes
+#include <vector>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+// TourArena - one contiguous slab of fixed size link blocks for GA tours
+//
+// Every slot of the population owns one block of n links for the whole run,
+// so once the population is built, crossover and mutation only ever rewrite
+// links in place. Requests that do not fit a block fall back to the heap.
+class TourArena
+{
+    public:
+        // Constructor (slots, links per slot)
+        TourArena(unsigned int, unsigned int);
+
+        // Destructor
+        ~TourArena();
+
+        // Hand out a block for count links
+        Link* allocate(std::size_t);
+
+        // Return a block (size unused, the address tells slab from heap)
+        void deallocate(Link*, std::size_t);
+
+        // Links per block
+        unsigned int blockLinks;
+
+        // Number of blocks in slab
+        unsigned int slots;
+
+        // Blocks handed out from the slab
+        long blockAllocs;
+
+        // Requests that had to go to the heap. Only the arena's own
+        // traffic, other GA scratch (kicks, the hash set, snapshots) is not
+        // counted
+        long heapAllocs;
+
+    private:
+        // Contiguous storage for every block
+        Link* slab;
+
+        // Blocks not in use
+        std::vector<Link*> freeBlocks;
+
+        // Guards the free list
+        std::mutex lock;
+};
+
+// ArenaAllocator - std allocator drawing from a TourArena (heap if none)
+template <class T>
+class ArenaAllocator
+{
+    public:
+        typedef T value_type;
+
+        // Moves and swaps carry the arena along, copies start on the heap
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+        typedef std::false_type propagate_on_container_copy_assignment;
+
+        // Constructor
+        ArenaAllocator(TourArena* arena = NULL) : arena(arena) {}
+
+        // Rebind constructor
+        template <class U>
+        ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+        // Copies of a tour do not take a slot
+        ArenaAllocator select_on_container_copy_construction() const
+        {
+            return ArenaAllocator();
+        }
+
+        // Allocate n objects
+        T* allocate(std::size_t n)
+        {
+            if(arena && std::is_same<T, Link>::value)
+                return (T*) arena->allocate(n);
+            return (T*) ::operator new(n * sizeof(T));
+        }
+
+        // Free n objects
+        void deallocate(T* p, std::size_t n)
+        {
+            if(arena && std::is_same<T, Link>::value)
+                arena->deallocate((Link*) p, n);
+            else
+                ::operator delete(p);
+        }
+
+        // Arena to draw from
+        TourArena* arena;
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+    return a.arena == b.arena;
+}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+    return a.arena != b.arena;
+}
+
+// Links of a tour
+typedef std::vector<Link, ArenaAllocator<Link>> LinkList;
+
+#endif // ARENA_H
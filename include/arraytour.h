@@ -0,0 +1,42 @@
+// Jacob Matchuny
+// TSP solver
+// Array tour header
+
+// Multiple inclusion protection
+#ifndef ARRAYTOUR_H
+#define ARRAYTOUR_H
+
+// Extern includes
+#include <vector>
+
+// ArrayTour - tour as city ids in order plus position of each id.
+// next / prev / between are O(1), flip reverses the shorter side in O(n).
+class ArrayTour
+{
+    public:
+        // Constructor (city ids in tour order)
+        ArrayTour(const std::vector<unsigned int>&);
+
+        // City after / before id
+        unsigned int next(unsigned int) const;
+        unsigned int prev(unsigned int) const;
+
+        // True if b lies on the forward path from a to c (inclusive)
+        bool between(unsigned int, unsigned int, unsigned int) const;
+
+        // With b = next(a) and d = next(c), replace edges a-b and c-d by a-c and b-d
+        void flip(unsigned int, unsigned int, unsigned int, unsigned int);
+
+        // City ids in tour order
+        std::vector<unsigned int> sequence() const;
+
+        // Number of cities
+        unsigned int size() const;
+
+    private:
+        std::vector<unsigned int> order;
+        std::vector<unsigned int> pos;
+        unsigned int n;
+};
+
+#endif // ARRAYTOUR_H
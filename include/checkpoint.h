@@ -0,0 +1,101 @@
+// Jacob Matchuny
+// TSP solver
+// Checkpoint header
+
+// Multiple inclusion protection
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+// Extern includes
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// GAState - everything the GA needs to pick a run up where it stopped
+struct GAState
+{
+    // Instance check: city count and coordinate hash
+    unsigned int cities = 0;
+    unsigned long long hash = 0;
+
+    // Run settings and counters
+    std::string algorithm;
+    int cross = 0, mutate = 0;
+    unsigned int genCount = 0, mutateCount = 0;
+
+    // Random engine (std::mt19937 text form)
+    std::string rng;
+
+    // City nums in the order of DataSet::cities
+    std::vector<unsigned int> cityOrder;
+
+    // Population tours as city ids, one tour after another, and their costs
+    std::vector<unsigned int> tours;
+    std::vector<float> costs;
+
+    // Finished wisdom experts, same layout
+    std::vector<unsigned int> experts;
+    std::vector<float> expertCosts;
+
+    // Adaptive GA: settings as adapted so far, stagnation tracking, population
+    // bounds and both operator selectors (OperatorSelector::save)
+    bool adaptive = false;
+    unsigned int popSize = 0, childCount = 0, basePopSize = 0;
+    double mutateFactor = 0, baseMutateFactor = 0;
+    unsigned int stallGenerations = 0;
+    float stallBest = 0;
+    unsigned int popMin = 0, popMax = 0, startPopulation = 0;
+    std::vector<double> crossSelector, mutateSelector;
+};
+
+// FNV-1a hash of the coordinates by city id
+unsigned long long coordinateHash(const std::vector<float>&, const std::vector<float>&);
+
+// Write state to a binary file (temp file then rename), false on failure
+bool writeState(const std::string&, const GAState&);
+
+// Read state from a binary file, false if missing or malformed
+bool readState(const std::string&, GAState&);
+
+// CheckpointWriter - writes states on a background thread. post() swaps the
+// state in and returns at once; a state posted while the last one is still
+// being written replaces any older one waiting.
+class CheckpointWriter
+{
+    public:
+        // Constructor (file path)
+        CheckpointWriter(const std::string&);
+
+        // Destructor, writes what is pending
+        ~CheckpointWriter();
+
+        // Hand a state to the writer (the argument is left empty)
+        void post(GAState&);
+
+        // Wait until every posted state is on disk
+        void flush();
+
+        // States written so far
+        unsigned int written;
+
+    private:
+        // File to write
+        std::string path;
+
+        // Latest state not yet written
+        GAState pending;
+        bool hasPending;
+
+        // Writer thread and its signals
+        std::thread worker;
+        std::mutex lock;
+        std::condition_variable wake, idle;
+        bool busy, halt;
+
+        // Writer loop
+        void run();
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,32 @@
+// Jacob Matchuny
+// TSP solver
+// Construction heuristics header
+
+// Multiple inclusion protection
+#ifndef CONSTRUCT_H
+#define CONSTRUCT_H
+
+// Extern includes
+#include <vector>
+#include <string>
+
+// Construction heuristics on a sparse candidate graph. Every function takes
+// coordinates by city id and the flat k-nearest candidate lists (k per city)
+// and returns a tour as city ids in visiting order.
+
+// Greedy edge matching: shortest candidate edges first, union-find rejects
+// cycles, leftover path fragments are joined nearest endpoint first
+std::vector<unsigned int> greedyEdgeTour(const std::vector<float>&, const std::vector<float>&, const std::vector<unsigned int>&, unsigned int);
+
+// Clarke-Wright savings around the city nearest the centroid, largest
+// saving first from a heap
+std::vector<unsigned int> savingsTour(const std::vector<float>&, const std::vector<float>&, const std::vector<unsigned int>&, unsigned int);
+
+// Christofides style: candidate graph MST, greedy matching of odd degree
+// cities, Euler circuit, shortcut
+std::vector<unsigned int> christofidesTour(const std::vector<float>&, const std::vector<float>&, const std::vector<unsigned int>&, unsigned int);
+
+// Run construction by name (greedy-edge, savings, christofides), empty if unknown
+std::vector<unsigned int> constructTour(const std::string&, const std::vector<float>&, const std::vector<float>&, const std::vector<unsigned int>&, unsigned int);
+
+#endif // CONSTRUCT_H
@@ -14,6 +14,25 @@
 // Includes from package
 #include "city.h"
 #include "link.h"
+#include "arena.h"
+#include "kernels.h"
+#include "hilbert.h"
+#include "spatialgrid.h"
+#include "construct.h"
+#include "lowerbound.h"
+#include "anneal.h"
+#include "aco.h"
+#include "tabu.h"
+#include "localsearch.h"
+#include "partition.h"
+#include "checkpoint.h"
+#include "edgehash.h"
+#include "incremental.h"
+#include "tourfile.h"
+#include "threadpool.h"
+#include "generator.h"
+#include "trace.h"
+#include "adaptive.h"
 
 // Extern includes
 #include <iostream>
@@ -23,6 +42,12 @@
 #include <algorithm>
 #include <iomanip>
 #include <ctime>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <unordered_map>
 
 // Graphics
 #include <cairo.h>
@@ -32,13 +57,16 @@
 struct Tour
 {
     // Vector of links
-    std::vector<Link> tour;
+    LinkList tour;
     
     // Cost of tour (summed distances)
-    float cost;
+    float cost = 0;
 
     // Execution time
-    double time;
+    double time = 0;
+
+    // Edge set hash (GA population)
+    unsigned long long hash = 0;
 
     // Operator for next_permutation
     bool operator<(const Tour& val) const
@@ -47,6 +75,42 @@ struct Tour
     }
 };
 
+// CrossScratch - crossover working storage, one per task breeding in parallel
+struct CrossScratch
+{
+    // Child cities in order and taken flags by city id
+    std::vector<City> cities;
+    std::vector<char> spots;
+
+    // City ids for the cost kernel
+    std::vector<unsigned int> order;
+};
+
+// Breeder - batch task state: its own random numbers and scratch
+struct Breeder
+{
+    std::mt19937 rng;
+    CrossScratch scratch;
+};
+
+// Snapshot - best tour so far as published by the solver thread for drawing
+struct Snapshot
+{
+    // City ids (num - 1) in tour order
+    std::vector<unsigned int> order;
+
+    // Cost, wall time in ms and solver step (generation, round, ...)
+    float cost = 0;
+    double time = 0;
+    long int step = 0;
+
+    // Solver finished
+    bool done = false;
+
+    // Convergence history as (time, cost) pairs
+    std::vector<std::pair<double, float>> history;
+};
+
 // Dataset - holds and analyzes data
 class DataSet
 {
@@ -70,12 +134,60 @@ class DataSet
         // List of cities from file
         std::vector<City> cities;
 
+        // City coordinates by num - 1 (SoA for kernels)
+        std::vector<float> xs, ys;
+
+        // Original city number by num - 1 after renumbering (empty if none)
+        std::vector<unsigned int> originalIds;
+
+        // Number to print for city num
+        unsigned int cityLabel(unsigned int);
+
+        // Renumber cities along a Hilbert curve for memory locality
+        void hilbertReorder();
+
+        // k nearest neighbors of each city id, k per city back to back
+        std::vector<unsigned int> candidates;
+
+        // Neighbors per city in candidates
+        unsigned int candidateK;
+
+        // Build candidate lists (no-op if already k wide)
+        void buildCandidates(unsigned int);
+
         // Read in cities / generate links
         void readInData();
+
+        // Read in cities from a stream (TSPLIB text or "x y" coordinate pairs)
+        void readInData(std::istream&);
+
+        // Check city numbering (1..n) and build coordinate arrays
+        void indexCities();
+
+        // Run the algorithm named by algorithm, false if unknown
+        bool solve();
+
+        // Algorithm dispatch for solve
+        bool solveAlgorithm();
+
+        // Cost of a tour through the vectorized kernel
+        float tourCost(const Tour&);
+
+        // Same with caller owned scratch, safe from parallel tasks
+        float tourCost(const Tour&, std::vector<unsigned int>&);
+
+        // Build tour links and cost from city ids (num - 1) in order
+        void buildTour(const std::vector<unsigned int>&, Tour&);
+
+        // Scratch permutation for tourCost
+        std::vector<unsigned int> permScratch;
         
         // Print results (best tour)
         void printResults();
 
+        // Print solver statistics (--stats)
+        void printStats();
+
         // Print graph
         void printGraph();
         
@@ -90,6 +202,42 @@ class DataSet
 
         // Number of tours calculated
         long int tourCount;
+
+        // Wall time budget in ms for iterative algorithms (0 = unlimited)
+        double timeBudget;
+
+        // Wall time in ms the current wisdom expert stops at (0 = end of timeBudget)
+        double expertDeadline;
+
+        // Wall clock start of the current solve
+        std::chrono::steady_clock::time_point startTime;
+
+        // Restart the wall clock
+        void startClock();
+
+        // Wall time since startClock in ms
+        double elapsed();
+
+        // True once timeBudget has been spent
+        bool outOfTime();
+
+        // Wall time since mark in ms, moves mark to now
+        double lap(double&);
+
+        // Print statistics with results
+        bool showStats;
+
+        // Run Held-Karp bound alongside the solver and report the gap
+        bool computeBound;
+
+        // Stop iterative solvers within this % of the bound (0 = off)
+        double targetGap;
+
+        // Background lower bound for the current solve
+        std::shared_ptr<LowerBound> lowerBound;
+
+        // True once cost is within targetGap of the bound
+        bool gapReached(float);
         // ---------------------
 
 
@@ -98,19 +246,51 @@ class DataSet
         // -------------------
 
 
+        // ------ SPACE FILLING CURVE ------
+        void sfc();
+        // ---------------------------------
+
+
+        // ------ CONSTRUCTION ------
+        void construct();
+
+        // Heuristic to run (greedy-edge, savings, christofides)
+        std::string constructMethod;
+        // --------------------------
+
+
         // ------ GREEDY ------
         void greedy();
 
+        // Nearest neighbor tour from cities[start] using the given visited mask,
+        // adds its links if asked, returns its cost
+        float greedyWalk(unsigned int, std::vector<unsigned int>&, LinkList*);
+
         // Get closest city to city
         void findClosestCity(City c1);
 
         // Check if all cities are added to graph
         bool allCitiesAdded();
+
+        // Visited bitmask by city num - 1 (32 cities per word)
+        std::vector<unsigned int> visited;
+
+        // Number of set bits in visited
+        unsigned int visitedCount;
+
+        // Clear visited bitmask
+        void resetVisited();
+
+        // Mark city id visited
+        void markVisited(unsigned int);
         // --------------------
 
 
         // ------ GENETIC ------
         void genetic();
+
+        // Storage for population tours, outlives population
+        std::shared_ptr<TourArena> arena;
         
         // Population for GA
         std::vector<Tour> population;
@@ -127,6 +307,16 @@ class DataSet
         // Initialize population for GA
         void initPop();
 
+        // Give population slots arena storage for n links each
+        void allocPop(unsigned int);
+
+        // Population seeding (greedy: every start + random, sfc: curve tours,
+        // or a construction heuristic name)
+        std::string initMethod;
+
+        // Fill population from seed tours (city ids), kicking extra copies
+        void initPopSeeded(const std::vector<std::vector<unsigned int>>&);
+
         // Print population for GA
         void printPop();
 
@@ -139,8 +329,23 @@ class DataSet
         // Crossover population
         void crossPop();
 
-        // Crossover population helper
-        Tour crossover(const Tour&, const Tour&);
+        // Crossover population helper, writes child into third argument
+        // (crossover to use, scratch and random numbers of the caller)
+        void crossover(const Tour&, const Tour&, Tour&, int, CrossScratch&, std::mt19937&);
+
+        // Cross two random parents from the first survivors into child, returns the crossover used
+        int breed(Tour&, unsigned int);
+
+        // Parent pair from the first survivors, fitter ones more often
+        void pickParents(unsigned int, std::mt19937&, unsigned int&, unsigned int&);
+
+        // Count a finished child / mutation for the trace and the adaptive
+        // rewards (survivors / cost before, operator used)
+        void countChild(const Tour&, unsigned int, int);
+        void countMutation(const Tour&, float, int);
+
+        // Crossover scratch of the serial path
+        CrossScratch crossScratch;
 
         // Crossover function to pick
         int cross;
@@ -150,11 +355,315 @@ class DataSet
 
         // Mutation count
         int mutateCount;
+
+        // Time spent in each GA step (ms)
+        double initTime, sortTime, crossTime, mutateTime;
+
+        // GA random numbers (saved with checkpoints)
+        std::mt19937 rng;
+
+        // Edge keys for population hashes
+        EdgeHash edgeHash;
+
+        // Population members per edge set hash
+        std::unordered_map<unsigned long long, unsigned int> hashCounts;
+
+        // Crossovers retried before a duplicate child is kicked instead
+        unsigned int duplicateRetries;
+
+        // Children rejected as copies of a population member
+        unsigned long duplicatesRejected;
+
+        // Hash every member, kicking copies apart when asked
+        void rehashPop(bool);
+
+        // Count / uncount a hash in hashCounts
+        void addHash(unsigned long long);
+        void dropHash(unsigned long long);
+
+        // XOR the keys of the listed links (each once) into the tour hash
+        void xorLinks(Tour&, std::initializer_list<int>);
+
+        // Reverse a random stretch of a tour (random numbers to use)
+        void kick(Tour&);
+        void kick(Tour&, std::mt19937&);
+
+        // Local search on every child before it joins the population
+        bool memetic;
+
+        // Improving moves each child may take (0 = until no move improves)
+        unsigned long memeticMoves;
+
+        // One local search per worker, built on first use each run
+        std::vector<std::shared_ptr<LocalSearch>> searchers;
+
+        // Children improved and improving moves made on them
+        unsigned long memeticChildren, memeticMoveCount;
+
+        // Local search population slots [first, last) in parallel
+        void improveChildren(unsigned int, unsigned int);
+
+        // Children bred per generation
+        unsigned int childCount;
+
+        // Children finished, all runs
+        unsigned long childrenBred;
         // ---------------------
+
+
+        // ------ BATCH ------
+        // Breed a whole batch of children in parallel each generation and
+        // merge it in one selection step (batchSize 0 = half the population)
+        bool batch;
+        unsigned int batchSize;
+
+        // Children per batch for a population size
+        unsigned int batchCount(unsigned int);
+
+        // Child slots, arena storage kept across generations
+        std::vector<Tour> offspring;
+
+        // Random numbers and scratch per task
+        std::vector<Breeder> breeders;
+
+        // Breed a batch from the sorted population, cheapest children replace the weakest members
+        void crossPopBatch();
+        // -------------------
+
+
+        // ------ ADAPTIVE ------
+        // Pick operators by adaptive pursuit, steer mutation rate and
+        // population size by stagnation and cost spread
+        bool adaptive;
+
+        // Crossover and mutation operator choice, relearned every run
+        OperatorSelector crossSelector, mutateSelector;
+
+        // Generations without a new best, and the best cost of the run
+        unsigned int stallGenerations;
+        float stallBest;
+
+        // Generations between adjustments, stalled generations that count as stuck
+        unsigned int adaptInterval, stallLimit;
+
+        // Population bounds (set on the first adjustment) and the population the run started with
+        unsigned int popMin, popMax, startPopulation;
+
+        // Configured population size and mutation rate every run starts from
+        unsigned int basePopSize;
+        double baseMutateFactor;
+
+        // Reset settings and selectors before a run
+        void startAdaptive();
+
+        // Track stagnation and adjust rate, population and children (population sorted)
+        void adaptPop();
+
+        // Add kicked copies of the fitter half / drop the weakest
+        void growPop(unsigned int);
+        void shrinkPop(unsigned int);
+        // ----------------------
+
+
+        // ------ CHECKPOINT ------
+        // Snapshot file (empty = off) and file to resume from
+        std::string checkpointPath, resumePath;
+
+        // Wall time between snapshots in ms
+        double checkpointInterval;
+
+        // Background writer, created on first use
+        std::shared_ptr<CheckpointWriter> checkpointer;
+
+        // Wall time of the last snapshot
+        double lastCheckpoint;
+
+        // Population restored, next genetic() skips initPop
+        bool resumePending;
+
+        // Resume file already read
+        bool resumeChecked;
+
+        // Hand GA state to the background writer
+        void saveCheckpoint();
+
+        // Restore GA state from resumePath (once), false if nothing restored
+        bool resumeCheckpoint();
+        // ------------------------
+
+
+        // ------ TRACE ------
+        // Trace file (empty = off) and generations between samples
+        std::string tracePath;
+        unsigned int traceEvery;
+
+        // Background writer, created on first use
+        std::shared_ptr<TraceSink> tracer;
+
+        // GA runs started (one per wisdom expert) and last generation sampled
+        unsigned int traceRuns;
+        long tracedGeneration;
+
+        // Children bred / accepted and mutations made / accepted since the last sample
+        unsigned int crossTried, crossAccepted, mutateTried, mutateAccepted;
+
+        // Sample the sorted population
+        void traceGeneration();
+        // -------------------
         
 
+        // ------ ANNEAL ------
+        void anneal();
+
+        // Replicas (0 = one per core, up to 8)
+        unsigned int annealReplicas;
+
+        // Hottest temperature in mean edges, cooling per sweep
+        double annealTemp, annealCooling;
+
+        // Moves tried / taken and replica swaps of the last run
+        long annealMoves, annealAccepted, annealExchanges, annealSwaps;
+        // --------------------
+
+
+        // ------ ANT COLONY ------
+        void aco();
+
+        // Ants per iteration
+        unsigned int antCount;
+
+        // Colony iterations of the last run
+        unsigned int antIterations;
+        // ------------------------
+
+
+        // ------ TABU ------
+        void tabu();
+
+        // Largest instance started from greedy(), its sweep over every start is O(n^3)
+        static const unsigned int tabuGreedyLimit = 1000;
+
+        // Shortest tenure in steps
+        unsigned int tabuTenure;
+
+        // Steps, new bests, aspiration moves and restarts of the last run
+        unsigned long tabuSteps, tabuImprovements, tabuAspirations, tabuRestarts;
+
+        // Start tour and local optimum costs of the last run
+        float tabuStart, tabuDescent;
+        // ------------------
+
+
+        // ------ PARTITION ------
+        void partition();
+
+        // Solve one cluster (city ids) with partAlgorithm, returns its tour as ids
+        std::vector<unsigned int> solveCluster(const std::vector<unsigned int>&, double);
+
+        // Algorithm run on each cluster
+        std::string partAlgorithm;
+
+        // Most cities per cluster
+        unsigned int clusterSize;
+
+        // Local search around cluster borders after stitching
+        bool polish;
+
+        // Clusters and polish moves of the last run
+        unsigned int clusterCount;
+        unsigned long polishMoves;
+        // -----------------------
+
+
+        // ------ LIVE VIEW ------
+        // Solve on a worker thread and publish snapshots for the window, false if unknown
+        bool solveLive();
+
+        // Wait for the worker thread
+        void waitSolve();
+
+        // Known algorithm name
+        bool knownAlgorithm();
+
+        // Publish a best tour (city ids or links), rate limited unless final
+        void publish(const std::vector<unsigned int>&, float, long int, bool = false);
+        void publish(const Tour&, long int, bool = false);
+
+        // Latest published snapshot (null before the first one), never blocks
+        std::shared_ptr<const Snapshot> latest();
+
+        // Snapshots are published only while a window is watching
+        bool liveView;
+
+        // Least wall time between snapshots in ms
+        double publishInterval;
+
+        // Wall time of the last snapshot
+        double lastPublish;
+
+        // Current snapshot, swapped atomically (readers keep the old one alive)
+        std::shared_ptr<const Snapshot> snapshot;
+
+        // Convergence history carried into each snapshot
+        std::vector<std::pair<double, float>> history;
+
+        // Worker thread (shared so the dataset stays copyable)
+        std::shared_ptr<std::thread> solver;
+        // -----------------------
+
+
+        // ------ TOUR FILES ------
+        // Read a .tour file to start from, false if unreadable
+        bool loadWarmStart(const std::string&);
+
+        // Write the cheapest tour as a .tour file
+        bool saveTour(const std::string&);
+
+        // City ids by file number (~0u where no city has the number)
+        std::vector<unsigned int> labelIndex();
+
+        // Warm start tour as city ids, covers every city once loaded
+        std::vector<unsigned int> warmOrder;
+
+        // True if a warm start tour matches the cities
+        bool warmStarted();
+
+        // File the cheapest tour is written to after solving (empty = off)
+        std::string tourOut;
+        // ------------------------
+
+
+        // ------ INCREMENTAL ------
+        // Apply a city delta to a previous tour and repair it locally
+        void update();
+
+        // Previous tour (.tour, city numbers) and delta ("+ num x y" / "- num" lines)
+        std::string tourPath, deltaPath;
+
+        // Swap in the city set after the delta, before any solver thread runs
+        void applyDelta();
+
+        // Read the delta, false if the file is missing
+        bool readDelta(std::vector<City>&, std::vector<unsigned int>&);
+
+        // Previous tour in new ids, cities still to insert and cities whose edges changed
+        std::vector<unsigned int> updateOrder, updateMissing, updateTouched;
+
+        // applyDelta has run, and its time in ms
+        bool deltaApplied;
+        double deltaTime;
+
+        // Cities added and removed, region searched and moves made by the last update
+        unsigned int insertedCount, removedCount, regionSize;
+        unsigned long updateMoves;
+        // -------------------------
+
+
         // ----- WISDOM OF CROWDS -----
         void wisdom();
+
+        // Fittest tour of each finished GA run
+        std::vector<Tour> experts;
         // ----------------------------
 };
 
@@ -0,0 +1,39 @@
+// Jacob Matchuny
+// TSP solver
+// Edge hash header
+
+// Multiple inclusion protection
+#ifndef EDGEHASH_H
+#define EDGEHASH_H
+
+// Includes from this project
+#include "arena.h"
+
+// Extern includes
+#include <vector>
+
+// EdgeHash - Zobrist style hash of a tour's edge set. Every city id gets a
+// random key, an undirected edge hashes its two keys and a tour is the XOR
+// of its edges, so the same cycle hashes the same from any start or
+// direction and swapping edges out and in updates the hash in O(1).
+class EdgeHash
+{
+    public:
+        // Constructor (city count, seed)
+        EdgeHash(unsigned int = 0, unsigned long long = 0x9e3779b97f4a7c15ULL);
+
+        // Key of the undirected edge between two city ids
+        unsigned long long key(unsigned int, unsigned int) const;
+
+        // Hash of a whole tour
+        unsigned long long tour(const LinkList&) const;
+
+        // Cities keyed
+        unsigned int size() const;
+
+    private:
+        // Random key per city id
+        std::vector<unsigned long long> keys;
+};
+
+#endif // EDGEHASH_H
@@ -0,0 +1,43 @@
+// Jacob Matchuny
+// TSP solver
+// Instance generator header
+
+// Multiple inclusion protection
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+// Includes from this project
+#include "city.h"
+
+// Extern includes
+#include <vector>
+#include <string>
+#include <istream>
+
+// Synthetic instances on a 1,000,000 square with integer coordinates, so
+// every size up to 10M cities keeps exact floats and few duplicate points.
+// Cities are streamed to the file one at a time and never held in memory.
+// Distributions:
+//   uniform   : independent uniform points
+//   clustered : Gaussian blobs of about 100 cities around uniform centers
+//   grid      : row major lattice, ceil(sqrt(n)) columns
+//   road      : cities strung along wandering roads, denser in towns
+// The generator uses its own splitmix64 stream and Box-Muller normals, so a
+// seed gives the same file on every compiler and platform.
+
+// Write a generated instance (path, distribution, city count, seed, binary
+// instead of TSPLIB text), false on an unknown distribution or write failure
+bool generateInstance(const std::string&, const std::string&, unsigned long, unsigned long long, bool);
+
+// Known distribution name
+bool knownDistribution(const std::string&);
+
+// Binary instance: 8 byte magic, 64 bit city count, then float x, y per city
+// (native byte order). True if the stream starts with the magic.
+bool isBinaryInstance(std::istream&);
+
+// Read a binary instance into cities numbered in file order, false if the
+// header is bad or the file is cut short
+bool readBinaryInstance(std::istream&, std::vector<City>&);
+
+#endif // GENERATOR_H
@@ -0,0 +1,20 @@
+// Jacob Matchuny
+// TSP solver
+// Hilbert curve header
+
+// Multiple inclusion protection
+#ifndef HILBERT_H
+#define HILBERT_H
+
+// Extern includes
+#include <vector>
+
+// Position of grid cell (x, y) along a Hilbert curve filling a 2^order grid
+unsigned long long hilbertIndex(unsigned int x, unsigned int y, unsigned int order);
+
+// City ids (index into xs / ys) sorted along a Hilbert curve over their
+// bounding box. variant 0..7 picks one of the eight mirror / rotations of
+// the curve so different calls give different, equally local, orders.
+std::vector<unsigned int> hilbertOrder(const std::vector<float>& xs, const std::vector<float>& ys, unsigned int variant = 0);
+
+#endif // HILBERT_H
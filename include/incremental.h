@@ -0,0 +1,33 @@
+// Jacob Matchuny
+// TSP solver
+// Incremental update header
+
+// Multiple inclusion protection
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+// Includes from this project
+#include "spatialgrid.h"
+
+// Extern includes
+#include <vector>
+
+// Tour repair after the city set changes. Tours are city ids in visiting
+// order; touched collects the ids whose tour edges changed so local search
+// can start from them alone.
+
+// Drop ids flagged in removed from a tour, the cities left on either side of
+// each gap are touched
+void removeCities(std::vector<unsigned int>& tour, const std::vector<char>& removed, std::vector<unsigned int>& touched);
+
+// Cheapest insertion of ids into a tour, trying the tour edges on both sides
+// of the nearest cities already placed (grid over every id). Inserted ids and
+// their new neighbors are touched.
+void insertCities(const SpatialGrid& grid, const std::vector<float>& xs, const std::vector<float>& ys, std::vector<unsigned int>& tour, const std::vector<unsigned int>& ids, std::vector<unsigned int>& touched);
+
+// k nearest candidate lists (k per city, flat) for the touched cities and
+// their neighbors only, every other list empty (~0u) so local search cannot
+// wander out of the region
+std::vector<unsigned int> regionCandidates(const SpatialGrid& grid, const std::vector<unsigned int>& touched, unsigned int k);
+
+#endif // INCREMENTAL_H
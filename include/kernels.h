@@ -0,0 +1,25 @@
+// Jacob Matchuny
+// TSP solver
+// Kernels header
+
+// Multiple inclusion protection
+#ifndef KERNELS_H
+#define KERNELS_H
+
+// Vectorized inner loops over SoA coordinates (xs[id], ys[id]).
+// The AVX2, SSE or scalar version is picked once at runtime.
+
+// Length of the closed tour visiting perm[0..n) in order
+float tourLength(const float* xs, const float* ys, const unsigned int* perm, unsigned int n);
+
+// Lengths of count tours of n cities stored back to back in perms
+void tourLengthBatch(const float* xs, const float* ys, const unsigned int* perms, unsigned int n, unsigned int count, float* out);
+
+// Closest id to (px, py) whose bit is clear in visited (32 ids per word),
+// compared on squared distance. Returns n if every id is visited.
+unsigned int nearestUnvisited(const float* xs, const float* ys, unsigned int n, const unsigned int* visited, float px, float py);
+
+// Name of the instruction set in use
+const char* kernelName();
+
+#endif // KERNELS_H
@@ -0,0 +1,79 @@
+// Jacob Matchuny
+// TSP solver
+// Local search header
+
+// Multiple inclusion protection
+#ifndef LOCALSEARCH_H
+#define LOCALSEARCH_H
+
+// Includes from this project
+#include "arraytour.h"
+#include "twoleveltour.h"
+
+// Extern includes
+#include <vector>
+#include <deque>
+
+// LocalSearch - first improvement 2-opt and or-opt over the k-nearest
+// candidate lists. A queue of active cities stands in for don't-look bits:
+// a city leaves the queue when no move around it improves and comes back
+// when one of its tour edges changes. Tours of twoLevelLimit cities or more
+// run on a TwoLevelTour, smaller ones on an ArrayTour.
+class LocalSearch
+{
+    public:
+        // Constructor (xs, ys, candidate lists, candidates per city)
+        LocalSearch(const std::vector<float>&, const std::vector<float>&, const std::vector<unsigned int>&, unsigned int);
+
+        // Improve tour (city ids) in place with every city active, returns gain
+        double optimize(std::vector<unsigned int>&);
+
+        // Improve tour in place with only the given cities active, returns gain
+        double optimize(std::vector<unsigned int>&, const std::vector<unsigned int>&);
+
+        // Improving move cap per call (0 = until no move improves)
+        unsigned long maxMoves;
+
+        // Try or-opt segment moves as well as 2-opt
+        bool useOrOpt;
+
+        // Improving moves applied by the last call
+        unsigned long moves;
+
+        // Smallest tour searched on a TwoLevelTour
+        static const unsigned int twoLevelLimit = 50000;
+
+    private:
+        // Problem
+        const std::vector<float>& xs;
+        const std::vector<float>& ys;
+        const std::vector<unsigned int>& candidates;
+        unsigned int k;
+        unsigned int n;
+
+        // Active cities
+        std::deque<unsigned int> queue;
+        std::vector<char> queued;
+
+        // Distance between ids
+        double dist(unsigned int, unsigned int) const;
+
+        // Make id active
+        void push(unsigned int);
+
+        // Drain the queue on either tour structure, returns gain
+        template<class TourType>
+        double search(TourType&);
+
+        // Remove edges a-b and c-d, add a-c and b-d, in either tour direction
+        template<class TourType>
+        void exchange(TourType&, unsigned int, unsigned int, unsigned int, unsigned int);
+
+        // Apply the first improving move around a city, adding to gain
+        template<class TourType>
+        bool improveTwoOpt(TourType&, unsigned int, double&);
+        template<class TourType>
+        bool improveOrOpt(TourType&, unsigned int, double&);
+};
+
+#endif // LOCALSEARCH_H
@@ -0,0 +1,87 @@
+// Jacob Matchuny
+// TSP solver
+// Lower bound header
+
+// Multiple inclusion protection
+#ifndef LOWERBOUND_H
+#define LOWERBOUND_H
+
+// Extern includes
+#include <vector>
+#include <atomic>
+#include <thread>
+
+// LowerBound - Held-Karp 1-tree bound improved by subgradient optimization
+//
+// Small instances use the complete graph, so the bound is a true lower bound.
+// Larger ones work on the candidate graph, which makes the result an
+// estimate (a 1-tree over a subgraph can exceed the full one), as in LKH.
+class LowerBound
+{
+    public:
+        // Constructor (xs, ys, candidate lists, candidates per city)
+        LowerBound(const std::vector<float>&, const std::vector<float>&, const std::vector<unsigned int>&, unsigned int);
+
+        // Destructor, stops background run
+        ~LowerBound();
+
+        // Run subgradient optimization on a background thread
+        void start();
+
+        // Ask background run to finish early
+        void stop();
+
+        // Wait for background run
+        void wait();
+
+        // Run subgradient optimization on this thread
+        void run();
+
+        // Best bound so far (0 until the first 1-tree)
+        float bound() const;
+
+        // True if computed on the complete graph
+        bool exact() const;
+
+        // Subgradient iterations done
+        unsigned int iterations() const;
+
+        // Instances up to this size use the complete graph
+        static const unsigned int denseLimit = 1000;
+
+        // Iteration cap
+        unsigned int maxIterations;
+
+    private:
+        // Coordinates and candidate graph (copied, the solver may move its own)
+        std::vector<float> xs, ys;
+        std::vector<unsigned int> candidates;
+        unsigned int candidateK;
+        std::vector<unsigned int> neighbors;
+        std::vector<unsigned int> neighborStart;
+
+        // Node penalties
+        std::vector<double> pi;
+
+        // Degrees in the last 1-tree
+        std::vector<int> degree;
+
+        // Background worker
+        std::thread worker;
+
+        // Shared with solver threads
+        std::atomic<float> best;
+        std::atomic<bool> halt;
+        std::atomic<unsigned int> done;
+        bool dense;
+
+        // Penalized edge weight
+        double weight(unsigned int, unsigned int) const;
+
+        // Build minimum 1-tree under pi, fills degree, returns its weight
+        double oneTree();
+        double oneTreeDense();
+        double oneTreeSparse();
+};
+
+#endif // LOWERBOUND_H
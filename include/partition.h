@@ -0,0 +1,22 @@
+// Jacob Matchuny
+// TSP solver
+// Partition header
+
+// Multiple inclusion protection
+#ifndef PARTITION_H
+#define PARTITION_H
+
+// Extern includes
+#include <vector>
+
+// Split city ids into spatial clusters of at most maxSize by recursive median
+// cuts across the longer side of each box. Clusters come back in Hilbert
+// order of their centroids so consecutive clusters are neighbors.
+std::vector<std::vector<unsigned int>> partitionCities(const std::vector<float>& xs, const std::vector<float>& ys, unsigned int maxSize);
+
+// Join closed cluster tours (city ids, clusters in visiting order) into one
+// tour. Each tour is entered at its city nearest the previous exit and cut
+// at the neighbor of that city facing the next cluster.
+std::vector<unsigned int> stitchTours(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<std::vector<unsigned int>>& tours);
+
+#endif // PARTITION_H
@@ -0,0 +1,119 @@
+// Jacob Matchuny
+// TSP solver
+// Server header
+
+// Multiple inclusion protection
+#ifndef SERVER_H
+#define SERVER_H
+
+// Includes from package
+#include "dataset.h"
+
+// Extern includes
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+// CachedResult - solved tour sent back to clients
+struct CachedResult
+{
+    // City numbers in tour order
+    std::vector<unsigned int> order;
+
+    // Cost of tour
+    float cost;
+
+    // Solve time in ms
+    double time;
+};
+
+// ResultCache - least recently used cache of solved instances
+class ResultCache
+{
+    public:
+        // Constructor
+        ResultCache(unsigned int);
+
+        // Look up key, marks it most recently used
+        bool get(unsigned long long, CachedResult&);
+
+        // Insert key, evicts least recently used past capacity
+        void put(unsigned long long, const CachedResult&);
+
+        // Number of cached results
+        unsigned int size() const;
+
+    private:
+        // Max entries kept
+        unsigned int capacity;
+
+        // Entries, most recently used at front
+        std::list<std::pair<unsigned long long, CachedResult>> entries;
+
+        // Key -> entry
+        std::unordered_map<unsigned long long, std::list<std::pair<unsigned long long, CachedResult>>::iterator> index;
+};
+
+// Server - long lived solver listening on a unix domain socket. Every
+// connection gets its own thread, so cache hits are answered while another
+// request solves and a stalled client only holds up itself.
+//
+// Request:  SOLVE <algorithm> <budget ms> <crossover> <mutator>
+//           <TSPLIB text or "x y" lines>
+//           END
+// Response: OK <cost> <time ms> <cached 0/1>
+//           <city numbers in tour order>
+//       or: ERR <message>
+class Server
+{
+    public:
+        // Constructor (socket path, cache entries)
+        Server(std::string, unsigned int);
+
+        // Destructor, removes socket file
+        ~Server();
+
+        // Accept and answer requests forever
+        void run();
+
+    private:
+        // Socket path
+        std::string path;
+
+        // Listening socket
+        int fd;
+
+        // Solved instances
+        ResultCache cache;
+
+        // Guards the cache and the request log
+        std::mutex lock;
+
+        // One solve at a time, each already spreads over the thread pool
+        std::mutex solving;
+
+        // Connections being served
+        std::atomic<unsigned int> clients;
+
+        // Most connections served at once
+        static const unsigned int maxClients = 64;
+
+        // Seconds a client may stall while sending or receiving
+        static const unsigned int clientTimeout = 10;
+
+        // Read, answer and close one connection
+        void serve(int);
+
+        // Answer one request, returns response text
+        std::string handle(std::istream&);
+};
+
+// Canonical hash of an instance and its solve options
+unsigned long long instanceHash(const std::vector<City>&, const std::string&, double, int, int);
+
+// Send an instance file to a server and print the response
+int runClient(std::string, std::string, std::string, double, int, int);
+
+#endif // SERVER_H
@@ -0,0 +1,65 @@
+// Jacob Matchuny
+// TSP solver
+// Spatial grid header
+
+// Multiple inclusion protection
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+// Extern includes
+#include <vector>
+#include <functional>
+
+// SpatialGrid - uniform bucket grid over city coordinates (about 2 cities per
+// cell) for nearest neighbor and k-nearest queries
+class SpatialGrid
+{
+    public:
+        // Constructor (xs, ys by city id)
+        SpatialGrid(const std::vector<float>&, const std::vector<float>&);
+
+        // Default constructor (empty grid)
+        SpatialGrid();
+
+        // k nearest ids to id, closest first, id itself excluded
+        void kNearest(unsigned int, unsigned int, std::vector<unsigned int>&) const;
+
+        // Closest id to (x, y) that is not removed and passes accept, n if none
+        unsigned int nearest(float, float, const std::function<bool(unsigned int)>&) const;
+
+        // Closest id to (x, y) that is not removed, n if none
+        unsigned int nearest(float, float) const;
+
+        // Hide id from nearest queries
+        void remove(unsigned int);
+
+        // Make every id visible again
+        void reset();
+
+        // Number of ids
+        unsigned int size() const;
+
+    private:
+        // Coordinates
+        const float* xs;
+        const float* ys;
+        unsigned int n;
+
+        // Grid geometry
+        float minX, minY, cellSize;
+        int cellsX, cellsY;
+
+        // Ids bucketed by cell (CSR layout)
+        std::vector<unsigned int> cellStart;
+        std::vector<unsigned int> cellItems;
+
+        // Live ids per cell and removed flags
+        std::vector<unsigned int> alive;
+        std::vector<char> removed;
+
+        // Cell coordinate of a point
+        int cellX(float) const;
+        int cellY(float) const;
+};
+
+#endif // SPATIALGRID_H
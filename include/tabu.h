@@ -0,0 +1,133 @@
+// Jacob Matchuny
+// TSP solver
+// Tabu search header
+
+// Multiple inclusion protection
+#ifndef TABU_H
+#define TABU_H
+
+// Includes from this project
+#include "arraytour.h"
+
+// Extern includes
+#include <vector>
+#include <random>
+#include <functional>
+
+// TabuMemory - open addressing table of forbidden edges. An undirected edge
+// is its two ids packed into one key, each slot holds the step the edge
+// stays tabu until. Slots whose step has passed count as free, so nothing
+// is ever erased; the table is rebuilt from the live slots when half full.
+class TabuMemory
+{
+    public:
+        // Constructor (expected live edges)
+        TabuMemory(unsigned int = 64);
+
+        // Forbid edge a-b until the given step (current step)
+        void forbid(unsigned int, unsigned int, unsigned long, unsigned long);
+
+        // Edge a-b still tabu at the given step
+        bool forbidden(unsigned int, unsigned int, unsigned long) const;
+
+        // Forget every edge
+        void clear();
+
+    private:
+        // Slot - packed edge (0 = empty) and last tabu step
+        struct Slot
+        {
+            unsigned long long key;
+            unsigned long until;
+        };
+
+        std::vector<Slot> slots;
+        unsigned long long mask;
+        unsigned int used;
+
+        // Key of the undirected edge
+        static unsigned long long pack(unsigned int, unsigned int);
+
+        // First probe slot of a key
+        unsigned long long home(unsigned long long) const;
+
+        // Keep only edges tabu after the given step, growing if still crowded
+        void rebuild(unsigned long);
+};
+
+// TabuMove - one 2-opt or or-opt move and its cost change.
+// 2-opt: remove a-b and c-d, add a-c and b-d.
+// Or-opt: segment a..b leaves c (before) and d (after) and goes between
+// e and f, reversed or not.
+struct TabuMove
+{
+    double delta;
+    bool orOpt, reversed;
+    unsigned int a, b, c, d, e, f;
+};
+
+// TabuSearch - best admissible move per step over the 2-opt and or-opt
+// neighbourhoods restricted to candidate lists. Every move forbids re-adding
+// the edges it removed for a randomized tenure, unless the result beats the
+// best tour (aspiration). Each step scores the whole neighbourhood on the
+// pool, one chunk of cities per task; after a long run without a new best
+// the search goes back to the best tour and kicks it.
+class TabuSearch
+{
+    public:
+        // Constructor (xs, ys, candidate lists, candidates per city)
+        TabuSearch(const std::vector<float>&, const std::vector<float>&, const std::vector<unsigned int>&, unsigned int);
+
+        // Search from a tour until maxSteps or stop(best tour, cost) is true, returns best tour
+        std::vector<unsigned int> run(const std::vector<unsigned int>&, const std::function<bool(const std::vector<unsigned int>&, float)>&);
+
+        // Shortest tenure in steps, each move draws from [tenure, 2 tenure)
+        unsigned int tenure;
+
+        // Steps without a new best before going back to it (0 = n)
+        unsigned long restartSteps;
+
+        // Step cap (0 = until stopped)
+        unsigned long maxSteps;
+
+        // Seed for tenures and kicks
+        unsigned int seed;
+
+        // Totals from the last run
+        unsigned long steps, improvements, aspirations, restarts;
+        float startCost, descentCost, bestCost;
+
+    private:
+        // Problem
+        const std::vector<float>& xs;
+        const std::vector<float>& ys;
+        const std::vector<unsigned int>& candidates;
+        unsigned int k;
+        unsigned int n;
+
+        // Distance between ids
+        double dist(unsigned int, unsigned int) const;
+
+        // Exact tour length
+        double length(const std::vector<unsigned int>&) const;
+
+        // Best admissible move around cities first..last - 1 into best
+        void scan(const ArrayTour&, const TabuMemory&, unsigned long, double, double, unsigned int, unsigned int, TabuMove&) const;
+
+        // Move re-adds a tabu edge
+        bool tabu(const TabuMemory&, unsigned long, const TabuMove&) const;
+
+        // Keep move if admissible and cheaper than best
+        void offer(const TabuMemory&, unsigned long, double, double, const TabuMove&, TabuMove&) const;
+
+        // Apply a move and forbid the edges it removed
+        void apply(ArrayTour&, TabuMemory&, const TabuMove&, unsigned long, std::mt19937&) const;
+
+        // Reverse a random stretch of up to 50 cities, forbidding the cut edges
+        void kick(ArrayTour&, TabuMemory&, unsigned long, std::mt19937&) const;
+
+        // Remove edges a-b and c-d, add a-c and b-d, in either tour direction
+        void exchange(ArrayTour&, unsigned int, unsigned int, unsigned int, unsigned int) const;
+};
+
+#endif // TABU_H
@@ -0,0 +1,111 @@
+// Jacob Matchuny
+// TSP solver
+// Thread pool header
+
+// Multiple inclusion protection
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+// Extern includes
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// ThreadPool - one work-stealing pool shared by every parallel solver. Each
+// worker owns a deque: it pushes and pops its own tasks at the back and
+// steals from the front of the others when it runs dry. Tasks forked from
+// outside the pool go to a shared queue. A thread that joins runs tasks of
+// that same join while it waits, never unrelated ones, so a short join
+// nested in a long task (a sweep inside the heuristic running next to the
+// bound) is not held up behind a stranger's task.
+class ThreadPool
+{
+    public:
+        // Pool used by all solvers, built on first use
+        static ThreadPool& instance();
+
+        // Threads (0 = one per core) and CPU pinning for instance(), call before first use
+        static void configure(unsigned int, bool);
+
+        // Constructor (threads counting the joining caller, pin workers to cores)
+        ThreadPool(unsigned int, bool);
+
+        // Destructor, stops the workers
+        ~ThreadPool();
+
+        // Threads that run tasks, the caller of forkJoin included
+        unsigned int size() const;
+
+        // Run every task, returns once all of them are done
+        void forkJoin(const std::vector<std::function<void()>>&);
+
+        // body(i) for every i in [begin, end), grain indices per task (0 = about four tasks per thread)
+        void parallelFor(unsigned int, unsigned int, const std::function<void(unsigned int)>&, unsigned int = 0);
+
+        // Tasks run, and tasks taken from another worker's deque
+        std::atomic<unsigned long> executed, stolen;
+
+    private:
+        // Join - tasks of one forkJoin not finished, and of those the ones
+        // still queued
+        struct Join
+        {
+            std::atomic<unsigned int> pending, queued;
+        };
+
+        // Task - work plus the join waiting on it
+        struct Task
+        {
+            std::function<void()> work;
+            Join* join;
+        };
+
+        // Worker - deque and thread
+        struct Worker
+        {
+            std::deque<Task> tasks;
+            std::mutex lock;
+            std::thread thread;
+        };
+
+        // Workers (size() - 1 of them)
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        // Tasks forked by threads outside the pool
+        std::deque<Task> shared;
+        std::mutex sharedLock;
+
+        // Idle workers sleep on wake until there is work, joining threads on
+        // joined until a task of theirs finishes
+        std::mutex sleepLock;
+        std::condition_variable wake, joined;
+        std::atomic<unsigned int> queued;
+        std::atomic<bool> halt;
+
+        // Settings for instance()
+        static unsigned int configuredThreads;
+        static bool configuredPin;
+
+        // Queue a task on this thread's deque, or the shared queue from outside
+        void push(Task);
+
+        // Own deque back, then the shared queue, then steal, false if all empty;
+        // given a join, only a task of that join from the own deque or shared queue
+        bool take(Task&, Join*);
+
+        // Shared queue task, of the given join if not null
+        bool takeShared(Task&, Join*);
+
+        // Run a task and count it off its join
+        void execute(Task&);
+
+        // Worker loop
+        void loop(unsigned int);
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,66 @@
+// Jacob Matchuny
+// TSP solver
+// Tour file header
+
+// Multiple inclusion protection
+#ifndef TOURFILE_H
+#define TOURFILE_H
+
+// Extern includes
+#include <vector>
+#include <string>
+#include <cstdio>
+
+// Read a TSPLIB .tour file: city numbers from TOUR_SECTION up to -1 or EOF.
+// Files without a TOUR_SECTION header are read as bare numbers. False if the
+// file is missing or holds no cities.
+bool readTour(const std::string&, std::vector<unsigned int>&);
+
+// Write city numbers as a TSPLIB .tour file (name, tour, length for the
+// comment line), false if the file could not be written
+bool writeTour(const std::string&, const std::string&, const std::vector<unsigned int>&, double);
+
+// TourWriter - buffered file output for large tours and instances. Numbers
+// are formatted by hand straight into a fixed buffer that goes to disk in
+// large blocks, so a million city tour costs a few writes instead of a stream
+// call per line.
+class TourWriter
+{
+    public:
+        // Constructor (file path)
+        TourWriter(const std::string&);
+
+        // Destructor, closes the file
+        ~TourWriter();
+
+        // Append text as is
+        void text(const std::string&);
+
+        // Append raw bytes
+        void bytes(const void*, size_t);
+
+        // Append a number and a separator after it
+        void number(long, char);
+
+        // Append a number on its own line
+        void line(long);
+
+        // Flush and close, false if anything failed
+        bool close();
+
+    private:
+        // Output file, null once closed or if it failed to open
+        FILE* file;
+
+        // Pending bytes
+        char buffer[1 << 16];
+        size_t used;
+
+        // Write error seen
+        bool failed;
+
+        // Write out pending bytes
+        void flush();
+};
+
+#endif // TOURFILE_H
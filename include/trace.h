@@ -0,0 +1,99 @@
+// Jacob Matchuny
+// TSP solver
+// Trace header
+
+// Multiple inclusion protection
+#ifndef TRACE_H
+#define TRACE_H
+
+// Extern includes
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// TraceRecord - one GA sample. Counts cover the generations since the last
+// sample. Fixed 56 byte layout (padded), written as is to binary traces.
+struct TraceRecord
+{
+    // Wall time since the solve started (ms)
+    double time;
+
+    // GA run (wisdom expert) and its generation
+    unsigned int run, generation;
+
+    // Population costs
+    float best, mean, worst;
+
+    // Distinct edge sets and population size
+    unsigned int distinct, population;
+
+    // Children bred / cheaper than the worst survivor
+    unsigned int crossTried, crossAccepted;
+
+    // Mutations made / that lowered the tour cost
+    unsigned int mutateTried, mutateAccepted;
+};
+
+// TraceSink - buffers records in memory and hands full blocks to a writer
+// thread, so the GA loop never touches the disk. Paths ending in .csv get
+// one text line per record, anything else the binary form (magic, then raw
+// records).
+class TraceSink
+{
+    public:
+        // Constructor (file path)
+        TraceSink(const std::string&);
+
+        // Destructor, writes what is buffered
+        ~TraceSink();
+
+        // Add a record
+        void record(const TraceRecord&);
+
+        // Hand the buffer over and wait until the file holds it
+        void flush();
+
+        // Records taken so far
+        unsigned long recorded;
+
+        // False if the file could not be opened or written
+        bool good();
+
+    private:
+        // Output file
+        FILE* file;
+        bool csv, failed;
+
+        // Records not yet handed to the writer
+        std::vector<TraceRecord> buffer;
+
+        // Blocks waiting for the writer
+        std::vector<std::vector<TraceRecord>> pending;
+
+        // Writer thread and its signals
+        std::thread worker;
+        std::mutex lock;
+        std::condition_variable wake, idle;
+        bool busy, halt;
+
+        // Queue the buffer for the writer
+        void post();
+
+        // Writer loop
+        void run();
+
+        // Format one block
+        void write(const std::vector<TraceRecord>&);
+};
+
+// Read a CSV or binary trace, false if missing or malformed
+bool readTrace(const std::string&, std::vector<TraceRecord>&);
+
+// Print time to target cost for each trace file (one setting per file) and
+// rank them, returns a process exit code
+int summarizeTraces(const std::vector<std::string>&, double);
+
+#endif // TRACE_H
@@ -0,0 +1,86 @@
+// Jacob Matchuny
+// TSP solver
+// Two-level tour header
+
+// Multiple inclusion protection
+#ifndef TWOLEVELTOUR_H
+#define TWOLEVELTOUR_H
+
+// Extern includes
+#include <vector>
+
+// TwoLevelTour - tour split into about sqrt(n) segments, each a block of
+// city ids with a reversed bit, kept in a list of segments in tour order.
+// next / prev / between are O(1). flip reverses inside one segment, or
+// splits the path ends off their segments and reverses the run of segments
+// between them, so it costs O(sqrt(n)). Splits are undone by a rebuild
+// once the segment count has doubled.
+class TwoLevelTour
+{
+    public:
+        // Constructor (city ids in tour order)
+        TwoLevelTour(const std::vector<unsigned int>&);
+
+        // City after / before id
+        unsigned int next(unsigned int) const;
+        unsigned int prev(unsigned int) const;
+
+        // True if b lies on the forward path from a to c (inclusive)
+        bool between(unsigned int, unsigned int, unsigned int) const;
+
+        // With b = next(a) and d = next(c), replace edges a-b and c-d by a-c and b-d
+        void flip(unsigned int, unsigned int, unsigned int, unsigned int);
+
+        // City ids in tour order
+        std::vector<unsigned int> sequence() const;
+
+        // Number of cities
+        unsigned int size() const;
+
+    private:
+        // Segment - block of city ids, walked backwards when reversed
+        struct Segment
+        {
+            std::vector<unsigned int> items;
+            bool reversed;
+            unsigned int rank;
+        };
+
+        // Segments by id and segment ids in tour order
+        std::vector<Segment> segments;
+        std::vector<unsigned int> order;
+
+        // Tour position of the first city of each rank
+        std::vector<unsigned int> start;
+
+        // Segment id and index in its items of each city
+        std::vector<unsigned int> seg;
+        std::vector<unsigned int> idx;
+
+        // Cities, segment count after the last rebuild
+        unsigned int n;
+        unsigned int built;
+
+        // Lay out segments of about sqrt(n) cities from a tour
+        void build(const std::vector<unsigned int>&);
+
+        // Position of id within its segment in tour direction
+        unsigned int offset(unsigned int) const;
+
+        // Position of id along the tour
+        unsigned int position(unsigned int) const;
+
+        // Reverse cities between two ids of one segment (inclusive)
+        void reverseInside(unsigned int, unsigned int);
+
+        // Make id the first city of its segment
+        void splitBefore(unsigned int);
+
+        // Reverse the segments of ranks i..j
+        void reverseRanks(unsigned int, unsigned int);
+
+        // Recompute ranks and starts from rank i on
+        void renumber(unsigned int);
+};
+
+#endif // TWOLEVELTOUR_H
@@ -0,0 +1,89 @@
+#!/bin/sh
+# Jacob Matchuny
+# TSP solver
+# Regression checks: runs the solver end to end on small instances and
+# compares what it prints. Exits non zero on the first failed check.
+#
+# Usage: scripts/check.sh
+# SOLVER=<binary> picks the solver, WORK=<dir> keeps the files there.
+
+SOLVER=${SOLVER:-./tsp-solver}
+WORK=${WORK:-$(mktemp -d)}
+
+if [ ! -x "$SOLVER" ]; then
+    echo "No solver at $SOLVER, run make first"
+    exit 1
+fi
+mkdir -p "$WORK"
+
+fail()
+{
+    echo "FAIL $*"
+    [ -n "$SERVER" ] && kill "$SERVER" 2> /dev/null
+    exit 1
+}
+
+# Tour the CLI printed, without the closing return to the start
+cli_tour()
+{
+    sed -n '/Final Path/{n;p;}' "$1" | tr -d '[]' | awk '{ NF--; $1 = $1; print }'
+}
+
+# ------ Client ------
+
+# Same cities numbered from 0, tours must come back in the file's numbers
+awk '/NODE_COORD_SECTION/ { print; section = 1; next }
+     section && $1 ~ /^[0-9]+$/ { print $1 - 1, $2, $3; next }
+     { print }' testfiles/Random40.tsp > "$WORK/zero40.tsp"
+"$SOLVER" generate uniform 2001 "$WORK/u2001.tsp" 1 > /dev/null || fail "generate"
+
+SOCKET=$WORK/solver.sock
+"$SOLVER" serve "$SOCKET" 8 > "$WORK/serve.log" 2>&1 &
+SERVER=$!
+for i in 1 2 3 4 5 6 7 8 9 10; do
+    [ -S "$SOCKET" ] && break
+    sleep 0.2
+done
+[ -S "$SOCKET" ] || fail "client: server did not start"
+
+"$SOLVER" "$WORK/zero40.tsp" greedy --headless > "$WORK/zero40.log" 2>&1 || fail "client: CLI greedy"
+expected=$(cli_tour "$WORK/zero40.log")
+
+"$SOLVER" client "$SOCKET" "$WORK/zero40.tsp" greedy 0 > "$WORK/zero40.reply"
+[ "$(sed -n 2p "$WORK/zero40.reply")" = "$expected" ] || fail "client: 0-based tour differs from the CLI"
+echo " $expected " | grep -q " 0 " || fail "client: 0-based tour has no city 0"
+
+"$SOLVER" client "$SOCKET" "$WORK/zero40.tsp" greedy 0 > "$WORK/zero40.cached"
+[ "$(awk 'NR == 1 { print $1, $4 }' "$WORK/zero40.cached")" = "OK 1" ] || fail "client: second request not cached"
+[ "$(sed -n 2p "$WORK/zero40.cached")" = "$expected" ] || fail "client: cached tour differs"
+
+# 1-based copy of the same cities is its own cache entry
+"$SOLVER" client "$SOCKET" testfiles/Random40.tsp greedy 0 > "$WORK/one40.reply"
+echo " $(sed -n 2p "$WORK/one40.reply") " | grep -q " 40 " || fail "client: 1-based tour answered from the 0-based entry"
+
+# Too large for the algorithm is an error, not a crash
+"$SOLVER" client "$SOCKET" "$WORK/u2001.tsp" wisdom 0 | grep -q "^ERR" || fail "client: oversized wisdom accepted"
+kill -0 "$SERVER" 2> /dev/null || fail "client: server died"
+
+kill "$SERVER"
+SERVER=
+echo "ok client"
+
+# ------ Resume ------
+
+# An adaptive GA stopped part way and resumed ends exactly like one that ran
+# straight through: same tour, same operator use, same adapted settings
+adapted()
+{
+    sed -n '/Final Path/{n;p;}; /^Adaptive/p' "$1"
+}
+
+"$SOLVER" testfiles/Random22.tsp genetic 1 1 --adaptive --stats --headless > "$WORK/straight.log" || fail "resume: straight run"
+"$SOLVER" testfiles/Random22.tsp genetic 1 1 --adaptive --headless --checkpoint="$WORK/adaptive.ckpt" --time=1000 > /dev/null || fail "resume: stopped run"
+"$SOLVER" testfiles/Random22.tsp genetic 1 1 --adaptive --stats --headless --resume="$WORK/adaptive.ckpt" > "$WORK/resumed.log" || fail "resume: resumed run"
+grep -q "^Resumed at generation" "$WORK/resumed.log" || fail "resume: checkpoint not read"
+[ -n "$(adapted "$WORK/straight.log")" ] || fail "resume: no adaptive stats"
+[ "$(adapted "$WORK/resumed.log")" = "$(adapted "$WORK/straight.log")" ] || fail "resume: adaptive run did not continue where it stopped"
+echo "ok resume"
+
+echo "All checks passed, files in $WORK"
@@ -0,0 +1,81 @@
+#!/bin/sh
+# Jacob Matchuny
+# TSP solver
+# Scaling run: generates instances at production sizes, solves them with
+# greedy-edge construction, partition and an incremental update, and checks
+# every tour written. Exits non zero on the first bad run.
+#
+# Usage: scripts/scaling.sh [sizes...]    (default 10000 100000 1000000)
+# SOLVER=<binary> picks the solver, WORK=<dir> keeps the files there.
+
+SOLVER=${SOLVER:-./tsp-solver}
+WORK=${WORK:-$(mktemp -d)}
+SIZES=${*:-"10000 100000 1000000"}
+
+if [ ! -x "$SOLVER" ]; then
+    echo "No solver at $SOLVER, run make first"
+    exit 1
+fi
+mkdir -p "$WORK"
+
+# Tour file holds each expected city number once: 1..n, less the delta's
+# removals, plus its additions
+check_tour()
+{
+    awk -v n="$2" '
+        FILENAME == ARGV[1] { if($1 == "-") { gone[$2] = 1; removals++ } else if($1 == "+") { added[$2] = 1; additions++ } next }
+        /TOUR_SECTION/ { section = 1; next }
+        section && $1 == -1 { exit }
+        section {
+            if(seen[$1]++ || !((($1 >= 1 && $1 <= n) && !($1 in gone)) || ($1 in added))) { bad = $1; exit }
+            count++
+        }
+        END {
+            expected = n - removals + additions
+            if(bad != "") { print "bad city " bad; exit 1 }
+            if(count != expected) { print count " cities, expected " expected; exit 1 }
+        }' "$3" "$1"
+}
+
+# Solve, check the tour written and print a table row
+run()
+{
+    label=$1 size=$2 tour=$3 delta=$4
+    shift 4
+
+    start=$(date +%s%N)
+    if ! "$SOLVER" "$@" --headless --out="$tour" > "$tour.log" 2>&1; then
+        echo "FAIL $label $size: solver exited with an error, see $tour.log"
+        exit 1
+    fi
+    ms=$(( ($(date +%s%N) - start) / 1000000 ))
+
+    if ! result=$(check_tour "$tour" "$size" "$delta"); then
+        echo "FAIL $label $size: $result"
+        exit 1
+    fi
+
+    cost=$(sed -n 's/^Cheapest Tour: \([^ ]*\).*/\1/p' "$tour.log")
+    printf "%-12s %-20s %8s ms  %s\n" "$size" "$label" "$ms" "$cost"
+}
+
+printf "%-12s %-20s %11s  %s\n" "cities" "run" "wall" "cost"
+for size in $SIZES; do
+    for dist in uniform clustered; do
+        base=$WORK/$dist$size
+        "$SOLVER" generate "$dist" "$size" "$base.bin" 1 --binary > /dev/null || exit 1
+
+        # Drop every 100th city, add as many new ones
+        awk -v n="$size" 'BEGIN {
+            srand(7)
+            for(i = 100; i <= n; i += 100) print "- " i
+            for(i = 1; i <= n / 100; i++) print "+ " n + i " " int(rand() * 1000000) " " int(rand() * 1000000)
+        }' > "$base.delta"
+
+        run "$dist:construct" "$size" "$base.tour" /dev/null "$base.bin" construct greedy-edge
+        run "$dist:partition" "$size" "$base.part.tour" /dev/null "$base.bin" partition construct greedy-edge --polish
+        run "$dist:update" "$size" "$base.update.tour" "$base.delta" "$base.bin" update "$base.tour" "$base.delta"
+    done
+done
+
+echo "All tours valid, files in $WORK"
@@ -0,0 +1,214 @@
+// Jacob Matchuny
+// TSP solver
+// Ant colony source
+
+// Includes from this project
+#include "aco.h"
+#include "threadpool.h"
+#include "kernels.h"
+
+// Extern includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Constructor
+AntColony::AntColony(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<unsigned int>& candidates, unsigned int k) : xs(xs), ys(ys), candidates(candidates)
+{
+    this->k = k;
+    this->n = xs.size();
+    this->ants = 25;
+    this->threads = ThreadPool::instance().size();
+    this->maxIterations = 1000;
+    this->alpha = 1;
+    this->beta = 2;
+    this->rho = 0.02;
+    this->pBest = 0.05;
+    this->seed = 1;
+    this->iterations = 0;
+    this->bestCost = 0;
+    this->trailMax = 0;
+    this->trailMin = 0;
+}
+
+// Distance between ids
+float AntColony::dist(unsigned int a, unsigned int b) const
+{
+    float dx = xs[a] - xs[b];
+    float dy = ys[a] - ys[b];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// One ant walk: roulette over unvisited candidates, nearest unvisited city
+// when every candidate is taken
+float AntColony::buildTour(Ant& ant)
+{
+    // New stamp clears visited flags
+    if(++ant.stamp == 0)
+    {
+        std::fill(ant.seen.begin(), ant.seen.end(), 0);
+        ant.stamp = 1;
+    }
+    ant.grid.reset();
+    ant.order.clear();
+
+    unsigned int city = ant.rng() % n;
+    ant.order.push_back(city);
+    ant.seen[city] = ant.stamp;
+    ant.grid.remove(city);
+
+    while(ant.order.size() < n)
+    {
+        double total = 0;
+        const unsigned int* list = &candidates[(size_t) city * k];
+        const double* weight = &choice[(size_t) city * k];
+        for(unsigned int c = 0; c < k; c++)
+        {
+            ant.weights[c] = list[c] < n && ant.seen[list[c]] != ant.stamp ? weight[c] : 0;
+            total += ant.weights[c];
+        }
+
+        unsigned int next = n;
+        if(total > 0)
+        {
+            double pick = std::uniform_real_distribution<double>(0, total)(ant.rng);
+            for(unsigned int c = 0; c < k && next == n; c++)
+            {
+                if(ant.weights[c] > 0 && (pick -= ant.weights[c]) <= 0)
+                    next = list[c];
+            }
+
+            // Rounding left pick slightly positive, take the last open candidate
+            for(unsigned int c = k; c > 0 && next == n; c--)
+                if(ant.weights[c - 1] > 0)
+                    next = list[c - 1];
+        }
+        else
+            next = ant.grid.nearest(xs[city], ys[city]);
+
+        ant.order.push_back(next);
+        ant.seen[next] = ant.stamp;
+        ant.grid.remove(next);
+        city = next;
+    }
+
+    return tourLength(xs.data(), ys.data(), ant.order.data(), n);
+}
+
+// Pheromone on both candidate slots of every tour edge
+void AntColony::deposit(const std::vector<unsigned int>& order, double amount)
+{
+    for(unsigned int i = 0; i < n; i++)
+    {
+        unsigned int a = order[i];
+        unsigned int b = order[(i + 1) % n];
+        for(unsigned int c = 0; c < k; c++)
+        {
+            if(candidates[(size_t) a * k + c] == b)
+                trail[(size_t) a * k + c] += amount;
+            if(candidates[(size_t) b * k + c] == a)
+                trail[(size_t) b * k + c] += amount;
+        }
+    }
+}
+
+// MMAS update with limits from the best cost so far
+void AntColony::update(const std::vector<unsigned int>& order, float cost)
+{
+    // Limits follow Stutzle and Hoos, about k / 2 choices left per step
+    double root = std::pow(pBest, 1.0 / n);
+    double options = std::max(2.0, k / 2.0);
+    trailMax = 1 / (rho * bestCost);
+    trailMin = trailMax * (1 - root) / ((options - 1) * root);
+
+    for(auto & t : trail)
+        t *= 1 - rho;
+
+    deposit(order, 1 / cost);
+
+    for(size_t slot = 0; slot < trail.size(); slot++)
+    {
+        trail[slot] = std::min(trailMax, std::max(trailMin, trail[slot]));
+
+        unsigned int j = candidates[slot];
+        if(j < n)
+            choice[slot] = std::pow(trail[slot], alpha) * std::pow(1 / (dist(slot / k, j) + 1e-6), beta);
+        else
+            choice[slot] = 0;
+    }
+}
+
+// Colony run
+std::vector<unsigned int> AntColony::run(const std::vector<unsigned int>& initial, const std::function<bool(const std::vector<unsigned int>&, float)>& stop)
+{
+    n = xs.size();
+    iterations = 0;
+
+    // First tour is the best so far and scales the trail limits
+    std::vector<unsigned int> best = initial;
+    if(n < 4 || k == 0)
+        return best;
+    bestCost = tourLength(xs.data(), ys.data(), best.data(), n);
+
+    trail.assign((size_t) n * k, 1 / (rho * bestCost));
+    choice.assign((size_t) n * k, 0);
+    update(best, bestCost);
+
+    // Per thread ants
+    unsigned int workers = std::max(1u, std::min(threads, ants));
+    std::vector<Ant> crew(workers);
+    for(unsigned int t = 0; t < workers; t++)
+    {
+        crew[t].seen.assign(n, 0);
+        crew[t].stamp = 0;
+        crew[t].grid = SpatialGrid(xs, ys);
+        crew[t].rng.seed(seed + 7919 * t);
+        crew[t].weights.resize(k);
+        crew[t].order.reserve(n);
+    }
+
+    // Task t walks ants t, t + workers, ...
+    auto walk = [&](unsigned int t)
+    {
+        Ant& ant = crew[t];
+        ant.bestCost = std::numeric_limits<float>::infinity();
+        for(unsigned int a = t; a < ants; a += workers)
+        {
+            float cost = buildTour(ant);
+            if(cost < ant.bestCost)
+            {
+                ant.bestCost = cost;
+                ant.best = ant.order;
+            }
+        }
+    };
+
+    while(iterations < maxIterations)
+    {
+        ThreadPool::instance().parallelFor(0, workers, walk, 1);
+
+        // Merge thread bests
+        unsigned int top = 0;
+        for(unsigned int t = 1; t < workers; t++)
+            if(crew[t].bestCost < crew[top].bestCost)
+                top = t;
+
+        if(crew[top].bestCost < bestCost)
+        {
+            bestCost = crew[top].bestCost;
+            best = crew[top].best;
+        }
+
+        // Iteration best deposits, best so far every fifth round
+        iterations++;
+        if(iterations % 5 == 0)
+            update(best, bestCost);
+        else
+            update(crew[top].best, crew[top].bestCost);
+
+        if(stop(best, bestCost))
+            break;
+    }
+
+    return best;
+}
@@ -0,0 +1,85 @@
+// Jacob Matchuny
+// TSP solver
+// Adaptive operator selection source
+
+// Includes from this project
+#include "adaptive.h"
+
+// Extern includes
+#include <algorithm>
+
+// Constructor
+OperatorSelector::OperatorSelector(unsigned int operators, double pMin, double alpha, double beta)
+{
+    this->uses.assign(operators, 0);
+    this->quality.assign(operators, 1);
+    this->chance.assign(operators, operators ? 1.0 / operators : 0);
+    this->pMin = operators > 1 ? std::min(pMin, 1.0 / operators) : 1;
+    this->pMax = 1 - (operators - 1) * this->pMin;
+    this->alpha = alpha;
+    this->beta = beta;
+}
+
+// Roulette over the probabilities
+unsigned int OperatorSelector::pick(std::mt19937& rng)
+{
+    double spin = std::uniform_real_distribution<double>(0, 1)(rng);
+    unsigned int op = 0;
+    while(op + 1 < chance.size() && (spin -= chance[op]) > 0)
+        op++;
+
+    return op;
+}
+
+// Update quality, then pursue the best operator
+void OperatorSelector::reward(unsigned int op, double gain)
+{
+    uses[op]++;
+    quality[op] += alpha * (gain - quality[op]);
+
+    unsigned int best = std::max_element(quality.begin(), quality.end()) - quality.begin();
+    for(unsigned int i = 0; i < chance.size(); i++)
+        chance[i] += beta * ((i == best ? pMax : pMin) - chance[i]);
+}
+
+// Current probability
+double OperatorSelector::probability(unsigned int op) const
+{
+    return chance[op];
+}
+
+// Operator count
+unsigned int OperatorSelector::size() const
+{
+    return chance.size();
+}
+
+// Three values per operator
+std::vector<double> OperatorSelector::save() const
+{
+    std::vector<double> values;
+    for(unsigned int i = 0; i < chance.size(); i++)
+    {
+        values.push_back(uses[i]);
+        values.push_back(quality[i]);
+        values.push_back(chance[i]);
+    }
+
+    return values;
+}
+
+// Same layout as save
+bool OperatorSelector::load(const std::vector<double>& values)
+{
+    if(values.size() != 3 * chance.size())
+        return false;
+
+    for(unsigned int i = 0; i < chance.size(); i++)
+    {
+        uses[i] = values[3 * i];
+        quality[i] = values[3 * i + 1];
+        chance[i] = values[3 * i + 2];
+    }
+
+    return true;
+}
@@ -0,0 +1,270 @@
+// Jacob Matchuny
+// TSP solver
+// Simulated annealing source
+
+// Includes from this project
+#include "anneal.h"
+#include "threadpool.h"
+
+// Extern includes
+#include <algorithm>
+#include <cmath>
+
+// Constructor
+Annealer::Annealer(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<unsigned int>& candidates, unsigned int k) : xs(xs), ys(ys), candidates(candidates)
+{
+    this->k = k;
+    this->n = xs.size();
+    this->replicas = std::max(2u, std::min(8u, ThreadPool::instance().size()));
+    this->startTemp = 0.5;
+    this->cooling = 0.98;
+    this->ladder = 0.3;
+    this->sweep = 1;
+    this->seed = 1;
+    this->moves = 0;
+    this->accepted = 0;
+    this->exchanges = 0;
+    this->swaps = 0;
+    this->rounds = 0;
+    this->bestCost = 0;
+}
+
+// Distance between ids
+double Annealer::dist(unsigned int a, unsigned int b) const
+{
+    double dx = xs[a] - xs[b];
+    double dy = ys[a] - ys[b];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Exact tour length
+double Annealer::length(const Replica& r) const
+{
+    double sum = 0;
+    for(unsigned int i = 0; i < n; i++)
+        sum += dist(r.order[i], r.order[(i + 1) % n]);
+    return sum;
+}
+
+// Metropolis test
+bool Annealer::accept(Replica& r, double delta)
+{
+    r.moves++;
+    if(delta > 0 && std::uniform_real_distribution<double>(0, 1)(r.rng) >= std::exp(-delta / r.temp))
+        return false;
+
+    r.accepted++;
+    return true;
+}
+
+// One random move around a random city
+void Annealer::step(Replica& r)
+{
+    unsigned int a = r.rng() % n;
+    unsigned int c = candidates[(size_t) a * k + r.rng() % k];
+    if(c >= n)
+        return;
+
+    unsigned int kind = r.rng() % 4;
+    if(kind < 2)
+        twoOpt(r, a, c, kind == 0);
+    else
+        orOpt(r, a, c, kind == 2 ? 1 : 1 + r.rng() % 3);
+}
+
+// 2-opt: new edge a - c plus the edge between their successors (or predecessors)
+void Annealer::twoOpt(Replica& r, unsigned int a, unsigned int c, bool successors)
+{
+    if(successors)
+    {
+        unsigned int b = r.order[(r.pos[a] + 1) % n];
+        unsigned int d = r.order[(r.pos[c] + 1) % n];
+        if(c == b || d == a)
+            return;
+
+        double delta = dist(a, c) + dist(b, d) - dist(a, b) - dist(c, d);
+        if(accept(r, delta))
+        {
+            reverse(r, r.pos[b], r.pos[c]);
+            r.cost += delta;
+        }
+    }
+    else
+    {
+        unsigned int pa = r.order[(r.pos[a] + n - 1) % n];
+        unsigned int pc = r.order[(r.pos[c] + n - 1) % n];
+        if(c == pa || pc == a)
+            return;
+
+        double delta = dist(a, c) + dist(pa, pc) - dist(pa, a) - dist(pc, c);
+        if(accept(r, delta))
+        {
+            reverse(r, r.pos[a], r.pos[pc]);
+            r.cost += delta;
+        }
+    }
+}
+
+// Or-opt: move segment of length cities starting at a so it touches c
+void Annealer::orOpt(Replica& r, unsigned int a, unsigned int c, unsigned int length)
+{
+    if(length + 2 >= n)
+        return;
+
+    unsigned int start = r.pos[a];
+    unsigned int first = a;
+    unsigned int last = r.order[(start + length - 1) % n];
+    unsigned int prev = r.order[(start + n - 1) % n];
+    unsigned int next = r.order[(start + length) % n];
+
+    // Insert after c keeping direction, or before c reversed
+    bool forward = r.rng() & 1;
+    unsigned int x = forward ? c : r.order[(r.pos[c] + n - 1) % n];
+    unsigned int offset = (r.pos[x] + n - start) % n;
+    if(offset < length || offset == n - 1 || (r.pos[c] + n - start) % n < length)
+        return;
+    unsigned int y = r.order[(r.pos[x] + 1) % n];
+
+    double delta = dist(prev, next) - dist(prev, first) - dist(last, next) - dist(x, y);
+    delta += forward ? dist(x, first) + dist(last, y) : dist(x, last) + dist(first, y);
+    if(!accept(r, delta))
+        return;
+
+    // Slide the segment past whichever side is shorter
+    if(offset + 1 <= n - offset - 1 + length)
+        rotate(r, start, offset + 1, length);
+    else
+        rotate(r, (start + offset + 1) % n, n - offset - 1 + length, n - offset - 1);
+
+    if(!forward)
+        reverse(r, r.pos[first], r.pos[last]);
+
+    r.cost += delta;
+}
+
+// Reverse path, flipping the shorter side (same cycle either way)
+void Annealer::reverse(Replica& r, unsigned int i, unsigned int j)
+{
+    unsigned int length = (j + n - i) % n + 1;
+    if(2 * length > n)
+    {
+        unsigned int nextI = (j + 1) % n;
+        j = (i + n - 1) % n;
+        i = nextI;
+        length = n - length;
+    }
+
+    for(unsigned int t = 0; t < length / 2; t++)
+    {
+        unsigned int p = (i + t) % n;
+        unsigned int q = (j + n - t) % n;
+        std::swap(r.order[p], r.order[q]);
+        r.pos[r.order[p]] = p;
+        r.pos[r.order[q]] = q;
+    }
+}
+
+// Rotate circular position range left
+void Annealer::rotate(Replica& r, unsigned int start, unsigned int total, unsigned int shift)
+{
+    r.scratch.resize(total);
+    for(unsigned int t = 0; t < total; t++)
+        r.scratch[t] = r.order[(start + t) % n];
+
+    for(unsigned int t = 0; t < total; t++)
+    {
+        unsigned int p = (start + t) % n;
+        r.order[p] = r.scratch[(t + shift) % total];
+        r.pos[r.order[p]] = p;
+    }
+}
+
+// Parallel tempering run
+std::vector<unsigned int> Annealer::run(const std::vector<unsigned int>& initial, const std::function<bool(const std::vector<unsigned int>&, float)>& stop)
+{
+    n = initial.size();
+    moves = accepted = exchanges = swaps = 0;
+    rounds = 0;
+
+    std::vector<unsigned int> best = initial;
+    if(n < 8 || k == 0)
+        return best;
+
+    // Every replica starts from the given tour
+    std::vector<Replica> chains(std::max(replicas, 1u));
+    for(unsigned int i = 0; i < chains.size(); i++)
+    {
+        Replica& r = chains[i];
+        r.order = initial;
+        r.pos.resize(n);
+        for(unsigned int p = 0; p < n; p++)
+            r.pos[r.order[p]] = p;
+        r.cost = length(r);
+        r.rng.seed(seed + 7919 * i);
+        r.moves = r.accepted = 0;
+    }
+
+    // Geometric ladder from hot to ladder * hot
+    double mean = chains[0].cost / n;
+    double hot = startTemp * mean;
+    std::vector<double> temps(chains.size());
+    for(unsigned int i = 0; i < chains.size(); i++)
+        temps[i] = hot * (chains.size() > 1 ? std::pow(ladder, (double) i / (chains.size() - 1)) : 1);
+
+    double bestLength = chains[0].cost;
+    unsigned long long steps = std::max(1.0, sweep * n);
+    std::uniform_real_distribution<double> coin(0, 1);
+    bool finished = false;
+
+    // Replicas sweep in parallel, then exchange and cool between rounds
+    while(!finished)
+    {
+        ThreadPool::instance().parallelFor(0, chains.size(), [&](unsigned int id)
+        {
+            Replica& r = chains[id];
+            r.temp = temps[id];
+            for(unsigned long long s = 0; s < steps; s++)
+                step(r);
+        }, 1);
+
+        // Drop accumulated rounding, keep best
+        for(auto & chain : chains)
+        {
+            chain.cost = length(chain);
+            if(chain.cost < bestLength)
+            {
+                bestLength = chain.cost;
+                best = chain.order;
+            }
+        }
+
+        // Swap neighbours on the ladder, alternating even and odd pairs
+        for(unsigned int i = rounds % 2; i + 1 < chains.size(); i += 2)
+        {
+            double chance = (chains[i].cost - chains[i + 1].cost) * (1 / temps[i] - 1 / temps[i + 1]);
+            exchanges++;
+            if(chance >= 0 || coin(chains[0].rng) < std::exp(chance))
+            {
+                std::swap(chains[i].order, chains[i + 1].order);
+                std::swap(chains[i].pos, chains[i + 1].pos);
+                std::swap(chains[i].cost, chains[i + 1].cost);
+                swaps++;
+            }
+        }
+
+        for(auto & temp : temps)
+            temp *= cooling;
+
+        rounds++;
+        finished = stop(best, (float) bestLength) || temps[0] < 1e-3 * mean;
+    }
+
+    for(auto & chain : chains)
+    {
+        moves += chain.moves;
+        accepted += chain.accepted;
+    }
+    bestCost = bestLength;
+
+    return best;
+}
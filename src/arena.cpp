@@ -0,0 +1,62 @@
+// Jacob Matchuny
+// TSP solver
+// Arena source
+
+// Includes from this project
+#include "arena.h"
+
+// Constructor
+TourArena::TourArena(unsigned int slots, unsigned int blockLinks)
+{
+    this->slots = slots;
+    this->blockLinks = blockLinks;
+    this->blockAllocs = 0;
+    this->heapAllocs = 0;
+
+    // One raw allocation for every slot, links are constructed by the vectors
+    this->slab = (Link*) ::operator new((size_t) slots * blockLinks * sizeof(Link));
+
+    // Hand out low addresses first
+    freeBlocks.reserve(slots);
+    for(unsigned int i = slots; i > 0; i--)
+        freeBlocks.push_back(slab + (size_t) (i - 1) * blockLinks);
+}
+
+// Deconstructor
+TourArena::~TourArena()
+{
+    ::operator delete(slab);
+}
+
+// Hand out a block
+Link* TourArena::allocate(std::size_t count)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if(count <= blockLinks && !freeBlocks.empty())
+        {
+            Link* block = freeBlocks.back();
+            freeBlocks.pop_back();
+            blockAllocs++;
+            return block;
+        }
+
+        heapAllocs++;
+    }
+
+    return (Link*) ::operator new(count * sizeof(Link));
+}
+
+// Return a block
+void TourArena::deallocate(Link* block, std::size_t)
+{
+    // Heap fallback
+    if(block < slab || block >= slab + (size_t) slots * blockLinks)
+    {
+        ::operator delete(block);
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    freeBlocks.push_back(block);
+}
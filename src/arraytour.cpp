@@ -0,0 +1,73 @@
+// Jacob Matchuny
+// TSP solver
+// Array tour source
+
+// Includes from this project
+#include "arraytour.h"
+
+// Extern includes
+#include <algorithm>
+
+// Constructor
+ArrayTour::ArrayTour(const std::vector<unsigned int>& order)
+{
+    this->order = order;
+    this->n = order.size();
+    this->pos.resize(n);
+    for(unsigned int i = 0; i < n; i++)
+        this->pos[order[i]] = i;
+}
+
+// Successor
+unsigned int ArrayTour::next(unsigned int id) const
+{
+    unsigned int p = pos[id] + 1;
+    return order[p == n ? 0 : p];
+}
+
+// Predecessor
+unsigned int ArrayTour::prev(unsigned int id) const
+{
+    unsigned int p = pos[id];
+    return order[p == 0 ? n - 1 : p - 1];
+}
+
+// b on path a -> c
+bool ArrayTour::between(unsigned int a, unsigned int b, unsigned int c) const
+{
+    return (pos[b] + n - pos[a]) % n <= (pos[c] + n - pos[a]) % n;
+}
+
+// 2-opt move, reversing b..c or d..a (same cycle either way)
+void ArrayTour::flip(unsigned int a, unsigned int b, unsigned int c, unsigned int d)
+{
+    unsigned int i = pos[b], j = pos[c];
+    unsigned int length = (j + n - i) % n + 1;
+    if(2 * length > n)
+    {
+        i = pos[d];
+        j = pos[a];
+        length = n - length;
+    }
+
+    for(unsigned int t = 0; t < length / 2; t++)
+    {
+        std::swap(order[i], order[j]);
+        pos[order[i]] = i;
+        pos[order[j]] = j;
+        i = i + 1 == n ? 0 : i + 1;
+        j = j == 0 ? n - 1 : j - 1;
+    }
+}
+
+// Tour order
+std::vector<unsigned int> ArrayTour::sequence() const
+{
+    return order;
+}
+
+// City count
+unsigned int ArrayTour::size() const
+{
+    return n;
+}
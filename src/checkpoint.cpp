@@ -0,0 +1,225 @@
+// Jacob Matchuny
+// TSP solver
+// Checkpoint source
+
+// Includes from this project
+#include "checkpoint.h"
+
+// Extern includes
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+
+// File magic, bump the digit when the layout changes
+static const char MAGIC[8] = { 'T', 'S', 'P', 'C', 'K', 'P', 'T', '2' };
+
+// Raw value out / in
+template <class T>
+static void put(std::ostream& out, const T& value)
+{
+    out.write((const char*) &value, sizeof(T));
+}
+
+template <class T>
+static bool get(std::istream& in, T& value)
+{
+    return (bool) in.read((char*) &value, sizeof(T));
+}
+
+// Length prefixed vector out / in
+template <class T>
+static void putVector(std::ostream& out, const std::vector<T>& values)
+{
+    put(out, (unsigned long long) values.size());
+    out.write((const char*) values.data(), values.size() * sizeof(T));
+}
+
+template <class T>
+static bool getVector(std::istream& in, std::vector<T>& values, unsigned long long limit)
+{
+    unsigned long long size;
+    if(!get(in, size) || size > limit)
+        return false;
+
+    values.resize(size);
+    return (bool) in.read((char*) values.data(), size * sizeof(T));
+}
+
+// Strings as char vectors
+static void putString(std::ostream& out, const std::string& value)
+{
+    putVector(out, std::vector<char>(value.begin(), value.end()));
+}
+
+static bool getString(std::istream& in, std::string& value)
+{
+    std::vector<char> chars;
+    if(!getVector(in, chars, 1 << 20))
+        return false;
+
+    value.assign(chars.begin(), chars.end());
+    return true;
+}
+
+// Coordinate hash
+unsigned long long coordinateHash(const std::vector<float>& xs, const std::vector<float>& ys)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    auto mix = [&hash](const void* data, size_t len)
+    {
+        const unsigned char* bytes = (const unsigned char*) data;
+        for(size_t i = 0; i < len; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    mix(xs.data(), xs.size() * sizeof(float));
+    mix(ys.data(), ys.size() * sizeof(float));
+    return hash;
+}
+
+// Write, never leaving a half written file behind
+bool writeState(const std::string& path, const GAState& state)
+{
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if(!out)
+            return false;
+
+        out.write(MAGIC, sizeof(MAGIC));
+        put(out, state.cities);
+        put(out, state.hash);
+        putString(out, state.algorithm);
+        put(out, state.cross);
+        put(out, state.mutate);
+        put(out, state.genCount);
+        put(out, state.mutateCount);
+        putString(out, state.rng);
+        putVector(out, state.cityOrder);
+        putVector(out, state.tours);
+        putVector(out, state.costs);
+        putVector(out, state.experts);
+        putVector(out, state.expertCosts);
+        put(out, state.adaptive);
+        put(out, state.popSize);
+        put(out, state.childCount);
+        put(out, state.basePopSize);
+        put(out, state.mutateFactor);
+        put(out, state.baseMutateFactor);
+        put(out, state.stallGenerations);
+        put(out, state.stallBest);
+        put(out, state.popMin);
+        put(out, state.popMax);
+        put(out, state.startPopulation);
+        putVector(out, state.crossSelector);
+        putVector(out, state.mutateSelector);
+
+        if(!out.flush())
+            return false;
+    }
+
+    return std::rename(temp.c_str(), path.c_str()) == 0;
+}
+
+// Read and sanity check sizes against the city count
+bool readState(const std::string& path, GAState& state)
+{
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    if(!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), MAGIC))
+        return false;
+
+    if(!get(in, state.cities) || !get(in, state.hash) || !getString(in, state.algorithm))
+        return false;
+    if(!get(in, state.cross) || !get(in, state.mutate) || !get(in, state.genCount) || !get(in, state.mutateCount))
+        return false;
+    if(!getString(in, state.rng))
+        return false;
+
+    unsigned long long n = state.cities, most = n * 100000ULL;
+    if(!getVector(in, state.cityOrder, n) || !getVector(in, state.tours, most) || !getVector(in, state.costs, most))
+        return false;
+    if(!getVector(in, state.experts, most) || !getVector(in, state.expertCosts, most))
+        return false;
+
+    if(!get(in, state.adaptive) || !get(in, state.popSize) || !get(in, state.childCount) || !get(in, state.basePopSize))
+        return false;
+    if(!get(in, state.mutateFactor) || !get(in, state.baseMutateFactor) || !get(in, state.stallGenerations) || !get(in, state.stallBest))
+        return false;
+    if(!get(in, state.popMin) || !get(in, state.popMax) || !get(in, state.startPopulation))
+        return false;
+    if(!getVector(in, state.crossSelector, 1024) || !getVector(in, state.mutateSelector, 1024))
+        return false;
+
+    return state.cityOrder.size() == n && state.tours.size() == state.costs.size() * n && state.experts.size() == state.expertCosts.size() * n;
+}
+
+// Constructor
+CheckpointWriter::CheckpointWriter(const std::string& path)
+{
+    this->path = path;
+    this->written = 0;
+    this->hasPending = false;
+    this->busy = false;
+    this->halt = false;
+    this->worker = std::thread(&CheckpointWriter::run, this);
+}
+
+// Destructor
+CheckpointWriter::~CheckpointWriter()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        halt = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+// Swap state in for the writer
+void CheckpointWriter::post(GAState& state)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::swap(pending, state);
+        hasPending = true;
+    }
+    wake.notify_one();
+    state = GAState();
+}
+
+// Wait for the writer to go idle
+void CheckpointWriter::flush()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    idle.wait(guard, [this] { return !hasPending && !busy; });
+}
+
+// Write whatever is pending until halted
+void CheckpointWriter::run()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    while(true)
+    {
+        wake.wait(guard, [this] { return hasPending || halt; });
+        if(!hasPending)
+            break;
+
+        // Write outside the lock so post never waits on the disk
+        GAState state;
+        std::swap(state, pending);
+        hasPending = false;
+        busy = true;
+        guard.unlock();
+
+        if(writeState(path, state))
+            written++;
+
+        guard.lock();
+        busy = false;
+        idle.notify_all();
+    }
+}
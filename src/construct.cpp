@@ -0,0 +1,346 @@
+// Jacob Matchuny
+// TSP solver
+// Construction heuristics source
+
+// Includes from this project
+#include "construct.h"
+#include "spatialgrid.h"
+
+// Extern includes
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <tuple>
+
+// No neighbor marker
+static const unsigned int NONE = ~0u;
+
+// Edge - weighted pair of city ids
+struct Edge
+{
+    float d;
+    unsigned int a, b;
+
+    bool operator<(const Edge& e) const
+    {
+        return std::tie(d, a, b) < std::tie(e.d, e.a, e.b);
+    }
+};
+
+// UnionFind - disjoint sets with path halving
+struct UnionFind
+{
+    std::vector<unsigned int> parent;
+
+    UnionFind(unsigned int n) : parent(n)
+    {
+        for(unsigned int i = 0; i < n; i++)
+            parent[i] = i;
+    }
+
+    unsigned int find(unsigned int i)
+    {
+        while(parent[i] != i)
+        {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    bool unite(unsigned int a, unsigned int b)
+    {
+        a = find(a);
+        b = find(b);
+        if(a == b)
+            return false;
+        parent[a] = b;
+        return true;
+    }
+};
+
+// Euclidian distance between ids
+static inline float dist(const std::vector<float>& xs, const std::vector<float>& ys, unsigned int a, unsigned int b)
+{
+    float dx = xs[a] - xs[b];
+    float dy = ys[a] - ys[b];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Unique undirected candidate edges sorted shortest first
+static std::vector<Edge> candidateEdges(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<unsigned int>& candidates, unsigned int k)
+{
+    std::vector<Edge> edges;
+    unsigned int n = xs.size();
+    edges.reserve((size_t) n * k);
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        for(unsigned int c = 0; c < k; c++)
+        {
+            unsigned int j = candidates[(size_t) i * k + c];
+            if(j != NONE && j != i)
+                edges.push_back({ dist(xs, ys, i, j), std::min(i, j), std::max(i, j) });
+        }
+    }
+
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end(), [](const Edge& e1, const Edge& e2) { return e1.a == e2.a && e1.b == e2.b; }), edges.end());
+    return edges;
+}
+
+// Add path edge a - b
+static inline void link(std::vector<unsigned int>& adj, std::vector<unsigned char>& deg, unsigned int a, unsigned int b)
+{
+    adj[2 * a + deg[a]++] = b;
+    adj[2 * b + deg[b]++] = a;
+}
+
+// Join path fragments (degree <= 2, no cycles) into one tour, walking each
+// fragment and jumping to the nearest free endpoint
+static std::vector<unsigned int> joinFragments(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<unsigned int>& adj, const std::vector<unsigned char>& deg, unsigned int start)
+{
+    unsigned int n = xs.size();
+    std::vector<unsigned int> order;
+    std::vector<char> used(n, false);
+    SpatialGrid grid(xs, ys);
+
+    order.reserve(n);
+
+    // Only free endpoints stay searchable
+    for(unsigned int i = 0; i < n; i++)
+        if(deg[i] == 2)
+            grid.remove(i);
+
+    unsigned int node = start;
+    while(node != NONE && node < n)
+    {
+        // Walk fragment to its far end
+        unsigned int prev = NONE;
+        while(true)
+        {
+            order.push_back(node);
+            used[node] = true;
+            grid.remove(node);
+
+            unsigned int next = NONE;
+            for(unsigned int s = 0; s < deg[node]; s++)
+                if(adj[2 * node + s] != prev && !used[adj[2 * node + s]])
+                    next = adj[2 * node + s];
+
+            if(next == NONE)
+                break;
+            prev = node;
+            node = next;
+        }
+
+        if(order.size() == n)
+            break;
+
+        // Closest endpoint of an unused fragment
+        node = grid.nearest(xs[node], ys[node]);
+    }
+
+    return order;
+}
+
+// Greedy edge matching
+std::vector<unsigned int> greedyEdgeTour(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<unsigned int>& candidates, unsigned int k)
+{
+    unsigned int n = xs.size();
+    std::vector<unsigned int> adj(2 * n, NONE);
+    std::vector<unsigned char> deg(n, 0);
+    UnionFind sets(n);
+
+    // Shortest edges first, never a third edge or an early cycle
+    for(auto & e : candidateEdges(xs, ys, candidates, k))
+        if(deg[e.a] < 2 && deg[e.b] < 2 && sets.unite(e.a, e.b))
+            link(adj, deg, e.a, e.b);
+
+    // Start from any endpoint
+    unsigned int start = 0;
+    while(start < n && deg[start] == 2)
+        start++;
+
+    return joinFragments(xs, ys, adj, deg, start < n ? start : 0);
+}
+
+// Clarke-Wright savings
+std::vector<unsigned int> savingsTour(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<unsigned int>& candidates, unsigned int k)
+{
+    unsigned int n = xs.size();
+    std::vector<unsigned int> adj(2 * n, NONE);
+    std::vector<unsigned char> deg(n, 0);
+    UnionFind sets(n);
+
+    if(n == 0)
+        return std::vector<unsigned int>();
+
+    // Hub is the city closest to the centroid
+    double cx = 0, cy = 0;
+    for(unsigned int i = 0; i < n; i++)
+    {
+        cx += xs[i];
+        cy += ys[i];
+    }
+    SpatialGrid grid(xs, ys);
+    unsigned int hub = grid.nearest(cx / n, cy / n);
+
+    // Saving of serving i and j on one route instead of two
+    std::priority_queue<std::tuple<float, unsigned int, unsigned int>> savings;
+    for(auto & e : candidateEdges(xs, ys, candidates, k))
+        if(e.a != hub && e.b != hub)
+            savings.push(std::make_tuple(dist(xs, ys, hub, e.a) + dist(xs, ys, hub, e.b) - e.d, e.a, e.b));
+
+    // Merge routes at their ends, largest saving first
+    while(!savings.empty())
+    {
+        unsigned int a = std::get<1>(savings.top());
+        unsigned int b = std::get<2>(savings.top());
+        savings.pop();
+
+        if(deg[a] < 2 && deg[b] < 2 && sets.unite(a, b))
+            link(adj, deg, a, b);
+    }
+
+    // Routes leave and return to the hub
+    return joinFragments(xs, ys, adj, deg, hub);
+}
+
+// Christofides style
+std::vector<unsigned int> christofidesTour(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<unsigned int>& candidates, unsigned int k)
+{
+    unsigned int n = xs.size();
+    std::vector<Edge> tree, edges = candidateEdges(xs, ys, candidates, k);
+    std::vector<unsigned int> degree(n, 0);
+    UnionFind sets(n);
+    SpatialGrid grid(xs, ys);
+
+    if(n < 3)
+    {
+        std::vector<unsigned int> order;
+        for(unsigned int i = 0; i < n; i++)
+            order.push_back(i);
+        return order;
+    }
+
+    // Kruskal over candidate edges
+    for(auto & e : edges)
+        if(sets.unite(e.a, e.b))
+            tree.push_back(e);
+
+    // Candidate graph may be disconnected, link each stray component to its nearest outsider
+    for(unsigned int i = 0; i < n && tree.size() < n - 1; i++)
+    {
+        if(sets.find(i) == sets.find(0))
+            continue;
+
+        unsigned int root = sets.find(i);
+        unsigned int other = grid.nearest(xs[i], ys[i], [&](unsigned int id) { return sets.find(id) != root; });
+        sets.unite(i, other);
+        tree.push_back({ dist(xs, ys, i, other), std::min(i, other), std::max(i, other) });
+    }
+
+    for(auto & e : tree)
+    {
+        degree[e.a]++;
+        degree[e.b]++;
+    }
+
+    // Greedy matching of odd degree cities, candidate edges first
+    std::vector<Edge> multigraph = tree;
+    std::vector<char> open(n, false);
+    for(unsigned int i = 0; i < n; i++)
+        open[i] = degree[i] % 2;
+
+    for(auto & e : edges)
+    {
+        if(open[e.a] && open[e.b])
+        {
+            open[e.a] = open[e.b] = false;
+            multigraph.push_back(e);
+        }
+    }
+
+    // Leftovers matched to their nearest open city
+    for(unsigned int i = 0; i < n; i++)
+        if(!open[i])
+            grid.remove(i);
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        if(!open[i])
+            continue;
+
+        open[i] = false;
+        grid.remove(i);
+        unsigned int other = grid.nearest(xs[i], ys[i]);
+        if(other >= n)
+            break;
+
+        open[other] = false;
+        grid.remove(other);
+        multigraph.push_back({ dist(xs, ys, i, other), i, other });
+    }
+
+    // Adjacency of edge ids (CSR)
+    std::vector<unsigned int> start(n + 1, 0), incident(2 * multigraph.size());
+    for(auto & e : multigraph)
+    {
+        start[e.a + 1]++;
+        start[e.b + 1]++;
+    }
+    for(unsigned int i = 0; i < n; i++)
+        start[i + 1] += start[i];
+
+    std::vector<unsigned int> fill(start.begin(), start.end() - 1);
+    for(unsigned int id = 0; id < multigraph.size(); id++)
+    {
+        incident[fill[multigraph[id].a]++] = id;
+        incident[fill[multigraph[id].b]++] = id;
+    }
+
+    // Hierholzer Euler circuit, shortcut repeated cities on the way out
+    std::vector<char> usedEdge(multigraph.size(), false), visited(n, false);
+    std::vector<unsigned int> next(start.begin(), start.end() - 1), stack, order;
+    stack.push_back(0);
+    order.reserve(n);
+
+    while(!stack.empty())
+    {
+        unsigned int v = stack.back();
+        while(next[v] < start[v + 1] && usedEdge[incident[next[v]]])
+            next[v]++;
+
+        if(next[v] == start[v + 1])
+        {
+            stack.pop_back();
+            if(!visited[v])
+            {
+                visited[v] = true;
+                order.push_back(v);
+            }
+        }
+        else
+        {
+            unsigned int id = incident[next[v]];
+            usedEdge[id] = true;
+            stack.push_back(multigraph[id].a == v ? multigraph[id].b : multigraph[id].a);
+        }
+    }
+
+    return order;
+}
+
+// Construction by name
+std::vector<unsigned int> constructTour(const std::string& method, const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<unsigned int>& candidates, unsigned int k)
+{
+    if(method.compare("greedy-edge") == 0)
+        return greedyEdgeTour(xs, ys, candidates, k);
+    else if(method.compare("savings") == 0)
+        return savingsTour(xs, ys, candidates, k);
+    else if(method.compare("christofides") == 0)
+        return christofidesTour(xs, ys, candidates, k);
+
+    return std::vector<unsigned int>();
+}
@@ -4,6 +4,8 @@
 
 // Extern includes
 #include <iostream>
+#include <cmath>
+#include <limits>
 
 // Includes from this project
 #include "dataset.h"
@@ -11,7 +13,40 @@
 // Function prototypes
 static std::string toStrMaxDecimals(double, int);
 static gboolean on_draw_event(GtkWidget*, cairo_t*, gpointer);
-static void do_drawing(cairo_t*);
+static gboolean on_timer(gpointer);
+static void on_destroy(GtkWidget*, gpointer);
+static void do_drawing(cairo_t*, int, int);
+static void update_view(cairo_t*, int, int);
+static void draw_tour(cairo_t*, const Snapshot&);
+static void draw_labeled_cities(cairo_t*);
+static void draw_convergence(cairo_t*, const Snapshot&);
+
+// Set when the window closes, iterative solvers treat it as out of time
+static std::atomic<bool> stopRequested(false);
+
+// Above this many cities draw fast: no labels, cached city layer, culled tour path
+static const unsigned int detailLimit = 500;
+
+// Tour points closer than this many pixels to the last one drawn are skipped
+static const double cullPixels = 2.0;
+
+// View - city to pixel mapping and the surfaces cached between redraws
+struct View
+{
+    // Pixel = coordinate * scale + offset
+    double scale = 1, offsetX = 0, offsetY = 0;
+
+    // Window size the cache was built for
+    int width = 0, height = 0;
+
+    // Background and cities (fast mode), rebuilt on resize
+    cairo_surface_t* layer = NULL;
+
+    // City marker painted at every city
+    cairo_surface_t* sprite = NULL;
+    double spriteRadius = 0;
+};
+static View view;
 
 // Global dataset, instantiated in main
 extern DataSet ds;
@@ -23,14 +58,91 @@ DataSet::DataSet(std::string filename)
     this->tourCount = 0;
     this->cheapestTour.cost = 0;
     this->tempTour.cost = 0;
+    this->deltaApplied = false;
+    this->deltaTime = 0;
     this->popSize = 150;
     this->mutateFactor = 0.15;
+    this->genCount = 0;
+    this->mutateCount = 0;
+    this->cross = 1;
+    this->mutate = 1;
+    this->timeBudget = 0;
+    this->expertDeadline = 0;
+    this->startTime = std::chrono::steady_clock::now();
+    this->showStats = false;
+    this->computeBound = false;
+    this->targetGap = 0;
+    this->initMethod = "greedy";
+    this->constructMethod = "greedy-edge";
+    this->candidateK = 0;
+    this->annealReplicas = 0;
+    this->annealTemp = 0.5;
+    this->annealCooling = 0.98;
+    this->annealMoves = 0;
+    this->annealAccepted = 0;
+    this->annealExchanges = 0;
+    this->annealSwaps = 0;
+    this->antCount = 25;
+    this->antIterations = 0;
+    this->tabuTenure = 40;
+    this->tabuSteps = 0;
+    this->tabuImprovements = 0;
+    this->tabuAspirations = 0;
+    this->tabuRestarts = 0;
+    this->tabuStart = 0;
+    this->tabuDescent = 0;
+    this->partAlgorithm = "construct";
+    this->clusterSize = 5000;
+    this->polish = false;
+    this->clusterCount = 0;
+    this->polishMoves = 0;
+    this->checkpointInterval = 10000;
+    this->lastCheckpoint = 0;
+    this->traceEvery = 10;
+    this->traceRuns = 0;
+    this->tracedGeneration = -1;
+    this->crossTried = 0;
+    this->crossAccepted = 0;
+    this->mutateTried = 0;
+    this->mutateAccepted = 0;
+    this->resumePending = false;
+    this->resumeChecked = false;
+    this->duplicateRetries = 3;
+    this->duplicatesRejected = 0;
+    this->memetic = false;
+    this->memeticMoves = 1000;
+    this->memeticChildren = 0;
+    this->memeticMoveCount = 0;
+    this->childCount = 3;
+    this->childrenBred = 0;
+    this->batch = false;
+    this->batchSize = 0;
+    this->adaptive = false;
+    this->stallGenerations = 0;
+    this->stallBest = 0;
+    this->adaptInterval = 25;
+    this->stallLimit = 100;
+    this->popMin = 0;
+    this->popMax = 0;
+    this->startPopulation = 0;
+    this->basePopSize = 0;
+    this->baseMutateFactor = 0;
+    this->insertedCount = 0;
+    this->removedCount = 0;
+    this->regionSize = 0;
+    this->updateMoves = 0;
+    this->liveView = false;
+    this->publishInterval = 50;
+    this->lastPublish = 0;
+    this->initTime = 0;
+    this->sortTime = 0;
+    this->crossTime = 0;
+    this->mutateTime = 0;
 }
 
 // Default constructor
-DataSet::DataSet()
+DataSet::DataSet() : DataSet("")
 {
-    this->tourCount = 0;
 }
 
 // Deconstructor
@@ -41,83 +153,913 @@ DataSet::~DataSet()
 // Read in data
 void DataSet::readInData()
 {
-    int num;
-    float x, y;
-
     std::ifstream file;
-    std::string line;
 
-    file.open(filename);
+    file.open(filename, std::ios::binary);
 
     // If file valid, parse
     if(file.good())
     {
         std::cout << "Reading from: " << filename << std::endl << std::endl;
+        readInData(file);
+    }
+    else
+    {
+        std::cout << "Bad file: " << filename << std::endl;
+    }
+
+    // Close file
+    file.close();
+}
+
+// Read in data from stream, accepts "num x y" and bare "x y" lines, or a
+// binary instance
+void DataSet::readInData(std::istream& in)
+{
+    // Binary instances number cities in file order
+    if(isBinaryInstance(in))
+    {
+        if(!readBinaryInstance(in, cities))
+        {
+            std::cout << "Bad binary instance: " << filename << std::endl;
+            cities.clear();
+        }
+        indexCities();
+        return;
+    }
+
+    std::string line;
+
+    while(std::getline(in, line))
+    {
+        std::istringstream iss(line);
+        std::vector<double> values;
+        double value;
+
+        while(iss >> value)
+            values.push_back(value);
 
-        while(!file.eof())
+        // Header stuff we dont want
+        if(!iss.eof() || values.size() < 2 || values.size() > 3)
+            continue;
+
+        // Add city, number bare coordinates in order
+        if(values.size() == 3)
+            cities.push_back(City(values[1], values[2], (unsigned int) values[0]));
+        else
+            cities.push_back(City(values[0], values[1], cities.size() + 1));
+    }
+
+    indexCities();
+}
+
+// Check numbering and build coordinate arrays
+void DataSet::indexCities()
+{
+    // Cities are addressed by num - 1, renumber in file order unless nums are 1..n
+    std::vector<bool> seen(cities.size(), false);
+    bool valid = true;
+    for(auto & city : cities)
+    {
+        if(city.num < 1 || city.num > cities.size() || seen[city.num - 1])
+        {
+            valid = false;
+            break;
+        }
+        seen[city.num - 1] = true;
+    }
+
+    // Keep the file's numbers as labels for output, tour files and deltas
+    if(!valid)
+    {
+        originalIds.assign(cities.size(), 0);
+        for(unsigned int i = 0; i < cities.size(); i++)
         {
-            std::getline(file, line);
-            std::istringstream iss(line);
-            if(!(iss >> num >> x >> y))
+            originalIds[i] = cities.at(i).num;
+            cities.at(i).num = i + 1;
+        }
+    }
+
+    xs.assign(cities.size(), 0);
+    ys.assign(cities.size(), 0);
+    for(auto & city : cities)
+    {
+        xs[city.num - 1] = city.x;
+        ys[city.num - 1] = city.y;
+    }
+}
+
+// Tour cost through kernel
+float DataSet::tourCost(const Tour& tour)
+{
+    return tourCost(tour, permScratch);
+}
+
+// Tour cost with the caller's permutation scratch
+float DataSet::tourCost(const Tour& tour, std::vector<unsigned int>& order)
+{
+    order.clear();
+    for(auto & link : tour.tour)
+        order.push_back(link.a.num - 1);
+
+    return tourLength(xs.data(), ys.data(), order.data(), order.size());
+}
+
+// Build tour from ids
+void DataSet::buildTour(const std::vector<unsigned int>& order, Tour& tour)
+{
+    tour.tour.clear();
+    for(unsigned int i = 0; i < order.size(); i++)
+    {
+        unsigned int a = order[i];
+        unsigned int b = order[(i + 1) % order.size()];
+        tour.tour.push_back(Link(City(xs[a], ys[a], a + 1), City(xs[b], ys[b], b + 1)));
+    }
+
+    tour.cost = tourLength(xs.data(), ys.data(), order.data(), order.size());
+}
+
+// Label printed for city num
+unsigned int DataSet::cityLabel(unsigned int num)
+{
+    return originalIds.empty() ? num : originalIds.at(num - 1);
+}
+
+// Renumber cities along a Hilbert curve so nearby cities sit together
+void DataSet::hilbertReorder()
+{
+    std::vector<unsigned int> order = hilbertOrder(xs, ys);
+    std::vector<unsigned int> rank(order.size()), labels(order.size());
+
+    for(unsigned int i = 0; i < order.size(); i++)
+    {
+        rank[order[i]] = i;
+        labels[i] = cityLabel(order[i] + 1);
+    }
+
+    // New num is position on the curve, keep cities in that order too
+    for(auto & city : cities)
+        city.num = rank[city.num - 1] + 1;
+    std::sort(cities.begin(), cities.end());
+
+    originalIds = labels;
+    indexCities();
+}
+
+// Flat k nearest candidate lists
+void DataSet::buildCandidates(unsigned int k)
+{
+    k = std::min(k, (unsigned int) cities.size() - 1);
+    if(candidateK == k && candidates.size() == (size_t) k * cities.size())
+        return;
+
+    SpatialGrid grid(xs, ys);
+    std::vector<unsigned int> nearest;
+
+    candidateK = k;
+    candidates.assign((size_t) k * cities.size(), ~0u);
+    for(unsigned int i = 0; i < cities.size(); i++)
+    {
+        grid.kNearest(i, k, nearest);
+        std::copy(nearest.begin(), nearest.end(), candidates.begin() + (size_t) i * k);
+    }
+}
+
+// Construction heuristic tour
+void DataSet::construct()
+{
+    cheapestTour.time = clock();
+
+    buildCandidates(10);
+    std::vector<unsigned int> order = constructTour(constructMethod, xs, ys, candidates, candidateK);
+    if(order.size() != cities.size())
+    {
+        std::cout << "Unknown construction: " << constructMethod << std::endl;
+        order = hilbertOrder(xs, ys);
+    }
+    buildTour(order, cheapestTour);
+    tourCount = 1;
+
+    // Convert clock ticks to ms
+    cheapestTour.time = (clock() - cheapestTour.time) * 1000 / (double) CLOCKS_PER_SEC;
+}
+
+// Space filling curve tour
+void DataSet::sfc()
+{
+    cheapestTour.time = clock();
+
+    // Visit cities in Hilbert order
+    buildTour(hilbertOrder(xs, ys), cheapestTour);
+    tourCount = 1;
+
+    // Convert clock ticks to ms
+    cheapestTour.time = (clock() - cheapestTour.time) * 1000 / (double) CLOCKS_PER_SEC;
+}
+
+// Simulated annealing from a greedy edge tour
+void DataSet::anneal()
+{
+    double start = elapsed();
+
+    buildCandidates(10);
+    Annealer annealer(xs, ys, candidates, candidateK);
+    if(annealReplicas > 0)
+        annealer.replicas = annealReplicas;
+    annealer.startTemp = annealTemp;
+    annealer.cooling = annealCooling;
+
+    // Stop on the wall budget or once close enough to the bound
+    auto stop = [this, &annealer](const std::vector<unsigned int>& best, float cost)
+    {
+        publish(best, cost, annealer.rounds);
+        return outOfTime() || gapReached(cost);
+    };
+    std::vector<unsigned int> order = annealer.run(warmStarted() ? warmOrder : greedyEdgeTour(xs, ys, candidates, candidateK), stop);
+    buildTour(order, cheapestTour);
+    tourCount = annealer.rounds;
+
+    annealMoves = annealer.moves;
+    annealAccepted = annealer.accepted;
+    annealExchanges = annealer.exchanges;
+    annealSwaps = annealer.swaps;
+
+    // Replicas run in parallel, so report wall time
+    cheapestTour.time = elapsed() - start;
+}
+
+// MAX-MIN ant system on the candidate graph
+void DataSet::aco()
+{
+    double start = elapsed();
+
+    buildCandidates(10);
+    AntColony colony(xs, ys, candidates, candidateK);
+    colony.ants = antCount;
+
+    // Stop on the wall budget or once close enough to the bound
+    auto stop = [this, &colony](const std::vector<unsigned int>& best, float cost)
+    {
+        publish(best, cost, (long int) colony.iterations * antCount);
+        return outOfTime() || gapReached(cost);
+    };
+    buildTour(colony.run(warmStarted() ? warmOrder : greedyEdgeTour(xs, ys, candidates, candidateK), stop), cheapestTour);
+    tourCount = (long int) colony.iterations * antCount;
+    antIterations = colony.iterations;
+
+    // Ants run in parallel, so report wall time
+    cheapestTour.time = elapsed() - start;
+}
+
+// Tabu search from the nearest neighbour tour
+void DataSet::tabu()
+{
+    double start = elapsed();
+
+    // greedy() is the best of every start, past its limit take a greedy edge tour
+    buildCandidates(10);
+    std::vector<unsigned int> order;
+    if(warmStarted())
+        order = warmOrder;
+    else if(cities.size() <= tabuGreedyLimit)
+    {
+        greedy();
+        for(auto & link : cheapestTour.tour)
+            order.push_back(link.a.num - 1);
+    }
+    else
+        order = greedyEdgeTour(xs, ys, candidates, candidateK);
+
+    TabuSearch search(xs, ys, candidates, candidateK);
+    search.tenure = std::max(1u, tabuTenure);
+
+    // A wall budget replaces the step cap
+    if(timeBudget > 0)
+        search.maxSteps = 0;
+
+    // Stop on the wall budget or once close enough to the bound
+    auto stop = [this, &search](const std::vector<unsigned int>& best, float cost)
+    {
+        publish(best, cost, search.steps);
+        return outOfTime() || gapReached(cost);
+    };
+    buildTour(search.run(order, stop), cheapestTour);
+    tourCount = search.steps;
+
+    tabuSteps = search.steps;
+    tabuImprovements = search.improvements;
+    tabuAspirations = search.aspirations;
+    tabuRestarts = search.restarts;
+    tabuStart = search.startCost;
+    tabuDescent = search.descentCost;
+
+    // Moves are scored in parallel, so report wall time
+    cheapestTour.time = elapsed() - start;
+}
+
+// Partition and stitch
+void DataSet::partition()
+{
+    double start = elapsed();
+
+    std::vector<std::vector<unsigned int>> clusters = partitionCities(xs, ys, clusterSize);
+    std::vector<std::vector<unsigned int>> tours(clusters.size());
+    clusterCount = clusters.size();
+
+    // One task per cluster, each wave of them gets an equal share of the budget
+    ThreadPool& pool = ThreadPool::instance();
+    unsigned int workers = std::max(1u, std::min((unsigned int) clusters.size(), pool.size()));
+    unsigned int waves = (clusters.size() + workers - 1) / workers;
+    double budget = timeBudget > 0 ? std::max(1.0, (timeBudget - elapsed()) * 0.9 / waves) : 0;
+
+    pool.parallelFor(0, clusters.size(), [&](unsigned int c) { tours[c] = solveCluster(clusters[c], budget); }, 1);
+
+    std::vector<unsigned int> order = stitchTours(xs, ys, tours);
+
+    // Only cities with a candidate in another cluster start active
+    if(polish && clusters.size() > 1)
+    {
+        buildCandidates(10);
+
+        std::vector<unsigned int> owner(cities.size()), border;
+        for(unsigned int c = 0; c < clusters.size(); c++)
+            for(unsigned int id : clusters[c])
+                owner[id] = c;
+
+        for(unsigned int i = 0; i < cities.size(); i++)
+        {
+            for(unsigned int c = 0; c < candidateK; c++)
             {
-                // Header stuff we dont want
-                continue;
+                unsigned int j = candidates[(size_t) i * candidateK + c];
+                if(j < cities.size() && owner[j] != owner[i])
+                {
+                    border.push_back(i);
+                    break;
+                }
             }
-
-            // Add city
-            cities.push_back(City(x, y, num));
         }
+
+        LocalSearch search(xs, ys, candidates, candidateK);
+        search.optimize(order, border);
+        polishMoves = search.moves;
+    }
+
+    buildTour(order, cheapestTour);
+    tourCount = clusterCount;
+
+    // Clusters run in parallel, so report wall time
+    cheapestTour.time = elapsed() - start;
+}
+
+// Cluster as its own dataset
+std::vector<unsigned int> DataSet::solveCluster(const std::vector<unsigned int>& ids, double budget)
+{
+    DataSet part;
+    part.algorithm = partAlgorithm.compare("partition") == 0 ? "construct" : partAlgorithm;
+    part.constructMethod = constructMethod;
+    part.initMethod = initMethod;
+    part.cross = cross;
+    part.mutate = mutate;
+    part.annealReplicas = annealReplicas;
+    part.annealTemp = annealTemp;
+    part.annealCooling = annealCooling;
+    part.antCount = antCount;
+    part.tabuTenure = tabuTenure;
+    part.timeBudget = budget;
+
+    for(unsigned int i = 0; i < ids.size(); i++)
+        part.cities.push_back(City(xs[ids[i]], ys[ids[i]], i + 1));
+    part.indexCities();
+
+    part.startClock();
+    std::vector<unsigned int> order;
+    if(part.solveAlgorithm() && part.cheapestTour.tour.size() == ids.size())
+    {
+        for(auto & link : part.cheapestTour.tour)
+            order.push_back(ids[link.a.num - 1]);
     }
     else
     {
-        std::cout << "Bad file: " << filename << std::endl;
+        // Unknown algorithm, keep the cluster in curve order
+        for(unsigned int i : hilbertOrder(part.xs, part.ys))
+            order.push_back(ids[i]);
     }
 
-    // Close file
-    file.close();
+    return order;
+}
+
+// Warm start from a tour file
+bool DataSet::loadWarmStart(const std::string& path)
+{
+    std::vector<unsigned int> labels;
+    if(!readTour(path, labels))
+    {
+        std::cout << "Bad tour file: " << path << std::endl;
+        return false;
+    }
+
+    // Known numbers once each, in file order
+    std::vector<unsigned int> idOf = labelIndex();
+    std::vector<char> onTour(cities.size(), false);
+    warmOrder.clear();
+    for(unsigned int label : labels)
+    {
+        unsigned int id = label < idOf.size() ? idOf[label] : ~0u;
+        if(id != ~0u && !onTour[id])
+        {
+            onTour[id] = true;
+            warmOrder.push_back(id);
+        }
+    }
+
+    // Cities the file leaves out go in by cheapest insertion
+    std::vector<unsigned int> missing, touched;
+    for(unsigned int id = 0; id < cities.size(); id++)
+        if(!onTour[id])
+            missing.push_back(id);
+    if(!missing.empty())
+    {
+        SpatialGrid grid(xs, ys);
+        insertCities(grid, xs, ys, warmOrder, missing, touched);
+    }
+
+    return true;
+}
+
+// Cheapest tour out
+bool DataSet::saveTour(const std::string& path)
+{
+    std::vector<unsigned int> labels;
+    labels.reserve(cheapestTour.tour.size());
+    for(auto & link : cheapestTour.tour)
+        labels.push_back(cityLabel(link.a.num));
+
+    // Name after the instance file, directory and extension dropped
+    std::string name = filename.substr(filename.find_last_of('/') + 1);
+    name = name.substr(0, name.find_last_of('.')) + ".tour";
+
+    if(!writeTour(path, name, labels, cheapestTour.cost))
+    {
+        std::cout << "Cannot write tour: " << path << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// File number to id
+std::vector<unsigned int> DataSet::labelIndex()
+{
+    std::vector<unsigned int> idOf;
+    for(unsigned int id = 0; id < cities.size(); id++)
+    {
+        unsigned int label = cityLabel(id + 1);
+        if(label >= idOf.size())
+            idOf.resize(label + 1, ~0u);
+        idOf[label] = id;
+    }
+
+    return idOf;
+}
+
+// Warm start matches this city set
+bool DataSet::warmStarted()
+{
+    return !cities.empty() && warmOrder.size() == cities.size();
+}
+
+// Incremental update of a previous tour
+void DataSet::update()
+{
+    double start = elapsed();
+
+    // Without a live view nothing draws, so the delta can go in here
+    if(!deltaApplied)
+        applyDelta();
+    deltaApplied = false;
+
+    // Insert around the nearest placed cities, then search only where the tour changed
+    std::vector<unsigned int>& order = updateOrder;
+    std::vector<unsigned int>& touched = updateTouched;
+    SpatialGrid grid(xs, ys);
+    insertCities(grid, xs, ys, order, updateMissing, touched);
+
+    std::vector<unsigned int> region = regionCandidates(grid, touched, 10);
+    unsigned int k = cities.empty() ? 0 : region.size() / cities.size();
+    LocalSearch search(xs, ys, region, k);
+    search.optimize(order, touched);
+    updateMoves = search.moves;
+
+    regionSize = 0;
+    for(unsigned int id = 0; k > 0 && id < cities.size(); id++)
+        if(region[(size_t) id * k] != ~0u)
+            regionSize++;
+
+    buildTour(order, cheapestTour);
+    tourCount = insertedCount + removedCount;
+    cheapestTour.time = deltaTime + elapsed() - start;
+}
+
+// Read the delta and previous tour and build the new city set. Runs before
+// the solver thread starts, the window reads xs, ys and labels unguarded.
+void DataSet::applyDelta()
+{
+    auto begin = std::chrono::steady_clock::now();
+    deltaApplied = true;
+
+    std::vector<City> added;
+    std::vector<unsigned int> gone, previous;
+    if(!readDelta(added, gone))
+        std::cout << "Bad delta file: " << deltaPath << std::endl;
+    if(!readTour(tourPath, previous))
+        std::cout << "Bad tour file: " << tourPath << std::endl;
+
+    // Old ids by label, removed ones flagged
+    std::vector<unsigned int> labels(cities.size()), idOf = labelIndex();
+    for(unsigned int id = 0; id < cities.size(); id++)
+        labels[id] = cityLabel(id + 1);
+    auto lookup = [&idOf](unsigned int label) { return label < idOf.size() ? idOf[label] : ~0u; };
+
+    std::vector<char> removed(cities.size(), false);
+    for(unsigned int label : gone)
+    {
+        unsigned int id = lookup(label);
+        if(id != ~0u && !removed[id])
+        {
+            removed[id] = true;
+            removedCount++;
+        }
+    }
+
+    // Previous tour in old ids, skipping unknown or repeated numbers
+    std::vector<unsigned int> order;
+    std::vector<char> onTour(cities.size(), false);
+    for(unsigned int label : previous)
+    {
+        unsigned int id = lookup(label);
+        if(id != ~0u && !onTour[id])
+        {
+            onTour[id] = true;
+            order.push_back(id);
+        }
+    }
+
+    std::vector<unsigned int> touched;
+    removeCities(order, removed, touched);
+
+    // New ids: kept cities in old order, then added ones
+    std::vector<unsigned int> newId(cities.size(), ~0u), newLabels, missing;
+    std::vector<City> kept;
+    for(unsigned int id = 0; id < cities.size(); id++)
+    {
+        if(removed[id])
+            continue;
+
+        newId[id] = kept.size();
+        kept.push_back(City(xs[id], ys[id], kept.size() + 1));
+        newLabels.push_back(labels[id]);
+
+        // Cities the old tour missed go in with the added ones
+        if(!onTour[id])
+            missing.push_back(newId[id]);
+    }
+    for(auto & city : added)
+    {
+        // Number already in use by a kept city
+        if(lookup(city.num) != ~0u && !removed[lookup(city.num)])
+            continue;
+
+        missing.push_back(kept.size());
+        kept.push_back(City(city.x, city.y, kept.size() + 1));
+        newLabels.push_back(city.num);
+        insertedCount++;
+    }
+
+    for(auto & id : order)
+        id = newId[id];
+    for(auto & id : touched)
+        id = newId[id];
+    updateOrder.swap(order);
+    updateTouched.swap(touched);
+    updateMissing.swap(missing);
+
+    // Ids change, so a warm start tour no longer applies
+    cities.swap(kept);
+    originalIds.swap(newLabels);
+    warmOrder.clear();
+    candidates.clear();
+    candidateK = 0;
+    indexCities();
+
+    deltaTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// Delta lines, "+ num x y" adds and "- num" removes
+bool DataSet::readDelta(std::vector<City>& added, std::vector<unsigned int>& removed)
+{
+    std::ifstream file(deltaPath);
+    if(!file.good())
+        return false;
+
+    std::string line;
+    while(std::getline(file, line))
+    {
+        std::istringstream iss(line);
+        std::string sign;
+        double num, x, y;
+        if(!(iss >> sign >> num))
+            continue;
+
+        if(sign.compare("+") == 0 && iss >> x >> y)
+            added.push_back(City(x, y, (unsigned int) num));
+        else if(sign.compare("-") == 0)
+            removed.push_back((unsigned int) num);
+    }
+
+    return true;
+}
+
+// Run algorithm by name
+bool DataSet::solve()
+{
+    startClock();
+
+    // Bound runs on its own thread, off the pool, so --gap can stop the
+    // heuristic even with a single pool thread
+    if(computeBound || targetGap > 0)
+    {
+        buildCandidates(10);
+        lowerBound = std::make_shared<LowerBound>(xs, ys, candidates, candidateK);
+        lowerBound->start();
+    }
+
+    bool known = solveAlgorithm();
+
+    // Keep the best bound reached so far rather than waiting out the run
+    if(lowerBound)
+    {
+        lowerBound->stop();
+        lowerBound->wait();
+    }
+
+    // Warm start stands unless the algorithm beat it
+    if(known && warmStarted())
+    {
+        Tour warm;
+        buildTour(warmOrder, warm);
+        if(cheapestTour.tour.size() != cities.size() || warm.cost < cheapestTour.cost)
+        {
+            cheapestTour.tour = warm.tour;
+            cheapestTour.cost = warm.cost;
+        }
+    }
+
+    // Window shows the final tour
+    if(known)
+        publish(cheapestTour, tourCount, true);
+
+    if(known && !tourOut.empty())
+        saveTour(tourOut);
+
+    return known;
+}
+
+// Dispatch on algorithm name
+bool DataSet::solveAlgorithm()
+{
+    if(algorithm.compare("brute") == 0)
+        brute();
+    else if(algorithm.compare("greedy") == 0)
+        greedy();
+    else if(algorithm.compare("genetic") == 0)
+    {
+        cheapestTour.time = clock();
+        genetic();
+
+        // Fittest individual is our solution
+        cheapestTour.tour = population.at(0).tour;
+        cheapestTour.cost = population.at(0).cost;
+        tourCount = genCount;
+
+        // Convert clock ticks to ms
+        cheapestTour.time = (clock() - cheapestTour.time) * 1000 / (double) CLOCKS_PER_SEC;
+    }
+    else if(algorithm.compare("wisdom") == 0)
+        wisdom();
+    else if(algorithm.compare("sfc") == 0)
+        sfc();
+    else if(algorithm.compare("construct") == 0)
+        construct();
+    else if(algorithm.compare("anneal") == 0)
+        anneal();
+    else if(algorithm.compare("aco") == 0)
+        aco();
+    else if(algorithm.compare("tabu") == 0)
+        tabu();
+    else if(algorithm.compare("partition") == 0)
+        partition();
+    else if(algorithm.compare("update") == 0)
+        update();
+    else
+        return false;
+
+    return true;
+}
+
+// Within targetGap of the bound
+bool DataSet::gapReached(float cost)
+{
+    if(targetGap <= 0 || !lowerBound)
+        return false;
+
+    float bound = lowerBound->bound();
+    return bound > 0 && (cost - bound) / bound * 100 <= targetGap;
+}
+
+// Restart wall clock
+void DataSet::startClock()
+{
+    startTime = std::chrono::steady_clock::now();
+}
+
+// Wall time in ms since startClock
+double DataSet::elapsed()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// Time budget spent
+bool DataSet::outOfTime()
+{
+    return stopRequested || (timeBudget > 0 && elapsed() >= (expertDeadline > 0 ? expertDeadline : timeBudget));
+}
+
+// Time since mark, advances mark
+double DataSet::lap(double& mark)
+{
+    double now = elapsed();
+    double spent = now - mark;
+    mark = now;
+    return spent;
 }
 
 // Brute force to generate tours
 void DataSet::brute()
 {
-    cheapestTour.time = clock();
-    // Calculate all tours
-    do
+    // Prefixes run in parallel, so time on the wall clock
+    double start = elapsed();
+
+    unsigned int n = cities.size();
+    std::vector<unsigned int> ids;
+    for(auto & city : cities)
+        ids.push_back(city.num - 1);
+    std::sort(ids.begin(), ids.end());
+
+    // One task per first city, each permutes the rest and scores a batch of
+    // tours per kernel call
+    const unsigned int batch = 64;
+    std::vector<std::vector<unsigned int>> bests(n);
+    std::vector<float> bestCosts(n, 0);
+    std::vector<long int> counts(n, 0);
+    ThreadPool::instance().parallelFor(0, n, [&](unsigned int first)
     {
-        // Create tour (for now)
-        Tour tour;
+        std::vector<unsigned int> order = ids, perms(batch * n);
+        std::rotate(order.begin(), order.begin() + first, order.begin() + first + 1);
+        float costs[batch];
+        bool more = true;
 
-        // Create links
-        for(unsigned int i = 0; i < cities.size() - 1; i++)
+        while(more)
         {
-            // Build link from  current city to next
-            tour.tour.push_back(Link(cities.at(i), cities.at(i + 1)));
+            unsigned int count = 0;
+            while(more && count < batch)
+            {
+                std::copy(order.begin(), order.end(), perms.begin() + count * n);
+                more = std::next_permutation(order.begin() + 1, order.end());
+                count++;
+            }
+
+            tourLengthBatch(xs.data(), ys.data(), perms.data(), n, count, costs);
+
+            // Adjust cheapest cost if need be
+            for(unsigned int i = 0; i < count; i++)
+            {
+                if(costs[i] < bestCosts[first] || bests[first].empty())
+                {
+                    bestCosts[first] = costs[i];
+                    bests[first].assign(perms.begin() + i * n, perms.begin() + (i + 1) * n);
+                }
+            }
+
+            counts[first] += count;
+            more = more && !outOfTime();
+        }
+    }, 1);
 
-            // Adjust cost
-            tour.cost += tour.tour.at(i).distance;
+    // Tasks in prefix order give the tour the serial sweep found first
+    std::vector<unsigned int> best;
+    for(unsigned int first = 0; first < n; first++)
+    {
+        if(!bests[first].empty() && (best.empty() || bestCosts[first] < cheapestTour.cost))
+        {
+            cheapestTour.cost = bestCosts[first];
+            best = bests[first];
         }
+        tourCount += counts[first];
+    }
+    publish(best, cheapestTour.cost, tourCount);
 
-        // Generate link to first city
-        tour.tour.push_back(Link(cities.back(), cities.front()));
-        tour.cost += tour.tour.back().distance;
+    // Links only for the winner
+    buildTour(best, cheapestTour);
 
-        // Adjust cheapest cost if need be
-        if(tour.cost < cheapestTour.cost || cheapestTour.cost == 0)
-            cheapestTour = tour;
+    cheapestTour.time = elapsed() - start;
+}
 
-        // Adjust tourCount
-        tourCount++;
-        tour.cost = 0;
-    } while(std::next_permutation(cities.begin(), cities.end()));
+// Solve on a worker thread, the window draws whatever it publishes
+bool DataSet::solveLive()
+{
+    if(!knownAlgorithm())
+        return false;
 
-    // Subtract current time from cheapestTour time
-    cheapestTour.time -= clock();
+    liveView = true;
+    solver = std::make_shared<std::thread>([this]()
+    {
+        solve();
+        printResults();
+    });
 
-    // Divide time by CPS to get time in secs
-    cheapestTour.time /= (double) CLOCKS_PER_SEC;
+    return true;
+}
 
-    // Time is currently negative so flip sign and convert to ms
-    cheapestTour.time *= -1000;
+// Join the worker thread
+void DataSet::waitSolve()
+{
+    if(solver && solver->joinable())
+        solver->join();
+}
+
+// Algorithms solveAlgorithm dispatches
+bool DataSet::knownAlgorithm()
+{
+    static const char* names[] = { "brute", "greedy", "genetic", "wisdom", "sfc", "construct", "anneal", "aco", "tabu", "partition", "update" };
+    for(const char* name : names)
+        if(algorithm.compare(name) == 0)
+            return true;
+
+    return false;
+}
+
+// Publish best tour so far
+void DataSet::publish(const std::vector<unsigned int>& order, float cost, long int step, bool final)
+{
+    if(!liveView || order.empty())
+        return;
+
+    // Only improvements, and no more often than publishInterval
+    std::shared_ptr<const Snapshot> last = latest();
+    double now = elapsed();
+    if(!final && (now - lastPublish < publishInterval || (last && cost >= last->cost)))
+        return;
+
+    // Halve the history rather than let it grow
+    if(history.size() >= 1024)
+    {
+        for(size_t i = 0; i < history.size() / 2; i++)
+            history[i] = history[2 * i];
+        history.resize(history.size() / 2);
+    }
+    history.push_back(std::make_pair(now, cost));
+
+    std::shared_ptr<Snapshot> next = std::make_shared<Snapshot>();
+    next->order = order;
+    next->cost = cost;
+    next->time = now;
+    next->step = step;
+    next->done = final;
+    next->history = history;
+
+    // Readers holding the old snapshot keep it alive until they let go
+    std::atomic_store(&snapshot, std::shared_ptr<const Snapshot>(next));
+    lastPublish = now;
+}
+
+// Publish tour links, only converted when a snapshot is due
+void DataSet::publish(const Tour& tour, long int step, bool final)
+{
+    if(!liveView || tour.tour.empty() || (!final && elapsed() - lastPublish < publishInterval))
+        return;
+
+    std::vector<unsigned int> order;
+    order.reserve(tour.tour.size());
+    for(auto & link : tour.tour)
+        order.push_back(link.a.num - 1);
+
+    publish(order, tour.cost, step, final);
+}
+
+// Latest snapshot
+std::shared_ptr<const Snapshot> DataSet::latest()
+{
+    return std::atomic_load(&snapshot);
 }
 
 // Print results
@@ -129,20 +1071,82 @@ void DataSet::printResults()
     std::cout << "Cities: " << cities.size() << std::endl;
     std::cout << "Tours Calculated: " << tourCount << std::endl << std::endl;
 
-    std::cout << "----- Final Path -----" << std::endl << "[ " << cheapestTour.tour.front().a.num << " ";
+    std::cout << "----- Final Path -----" << std::endl << "[ " << cityLabel(cheapestTour.tour.front().a.num) << " ";
     for(auto & link : cheapestTour.tour)
-        std::cout << link.b.num << " ";
+        std::cout << cityLabel(link.b.num) << " ";
     std::cout << "]" << std::endl;
 
     std::cout << "----------------------" << std::endl << std::endl;
     std::cout << "Cheapest Tour: " << cheapestTour.cost << " ";
     std::cout << "Execution Time: " << cheapestTour.time << std::endl;
 
+    if(lowerBound && lowerBound->bound() > 0)
+    {
+        std::cout << "Lower Bound: " << lowerBound->bound() << (lowerBound->exact() ? " (Held-Karp) " : " (Held-Karp estimate) ");
+        std::cout << "Gap: " << toStrMaxDecimals((cheapestTour.cost - lowerBound->bound()) / lowerBound->bound() * 100, 2) << "%" << std::endl;
+    }
+
     if(!algorithm.compare("genetic"))
     {
         std::cout << "Mutations: " << mutateCount << std::endl;
         std::cout << "Generations: " << genCount << std::endl;
     }
+
+    if(showStats)
+        printStats();
+}
+
+// Print solver statistics
+void DataSet::printStats()
+{
+    std::cout << std::endl << "----- Stats -----" << std::endl;
+    std::cout << "Wall Time: " << toStrMaxDecimals(elapsed(), 2) << " ms" << std::endl;
+    std::cout << "Cost Kernel: " << kernelName() << std::endl;
+
+    // Only the GA uses the arena
+    if(arena)
+    {
+        std::cout << "Arena Slots: " << population.size() << " x " << arena->blockLinks << " links" << std::endl;
+        std::cout << "Arena Blocks Handed Out: " << arena->blockAllocs << std::endl;
+        std::cout << "Arena Fallbacks: " << arena->heapAllocs << std::endl;
+        std::cout << "Init Time: " << toStrMaxDecimals(initTime, 2) << " ms" << std::endl;
+        std::cout << "Sort Time: " << toStrMaxDecimals(sortTime, 2) << " ms" << std::endl;
+        std::cout << "Crossover Time: " << toStrMaxDecimals(crossTime, 2) << " ms" << std::endl;
+        std::cout << "Mutate Time: " << toStrMaxDecimals(mutateTime, 2) << " ms" << std::endl;
+        if(memetic)
+            std::cout << "Memetic Moves: " << memeticMoveCount << " over " << memeticChildren << " children" << std::endl;
+        std::cout << "Children Bred: " << childrenBred << " (" << (crossTime > 0 ? (long) (childrenBred / (crossTime / 1000)) : 0) << " / s of crossover time)" << std::endl;
+        std::cout << "Diversity: " << hashCounts.size() << " / " << population.size() << " distinct (" << duplicatesRejected << " duplicate children rejected)" << std::endl;
+        if(adaptive)
+        {
+            std::cout << "Adaptive Crossover: " << crossSelector.uses[0] << " / " << crossSelector.uses[1] << " (p " << toStrMaxDecimals(crossSelector.probability(0), 2) << " / " << toStrMaxDecimals(crossSelector.probability(1), 2) << ")" << std::endl;
+            std::cout << "Adaptive Mutation: " << mutateSelector.uses[0] << " / " << mutateSelector.uses[1] << " (p " << toStrMaxDecimals(mutateSelector.probability(0), 2) << " / " << toStrMaxDecimals(mutateSelector.probability(1), 2) << ")" << std::endl;
+            std::cout << "Adaptive Population: " << startPopulation << " -> " << population.size() << ", mutation rate " << baseMutateFactor << " -> " << toStrMaxDecimals(mutateFactor, 3) << ", " << childCount << " children" << std::endl;
+        }
+    }
+    if(annealMoves > 0)
+    {
+        std::cout << "Anneal Moves: " << annealMoves << " (" << annealAccepted << " accepted)" << std::endl;
+        std::cout << "Replica Swaps: " << annealSwaps << " / " << annealExchanges << std::endl;
+    }
+    if(antIterations > 0)
+        std::cout << "Colony Iterations: " << antIterations << " x " << antCount << " ants" << std::endl;
+    if(tabuSteps > 0)
+    {
+        std::cout << "Tabu Steps: " << tabuSteps << " (" << tabuImprovements << " new bests, " << tabuAspirations << " aspirations, " << tabuRestarts << " restarts)" << std::endl;
+        std::cout << "Tabu Start: " << tabuStart << " -> " << tabuDescent << " after local search" << std::endl;
+    }
+    if(checkpointer)
+        std::cout << "Checkpoints Written: " << checkpointer->written << std::endl;
+    if(tracer)
+        std::cout << "Trace Records: " << tracer->recorded << (tracer->good() ? "" : " (write failed)") << std::endl;
+    if(insertedCount + removedCount > 0)
+        std::cout << "Delta: +" << insertedCount << " -" << removedCount << " (" << regionSize << " cities searched, " << updateMoves << " moves)" << std::endl;
+    ThreadPool& pool = ThreadPool::instance();
+    std::cout << "Thread Pool: " << pool.size() << " threads, " << pool.executed << " tasks (" << pool.stolen << " stolen)" << std::endl;
+    if(clusterCount > 0)
+        std::cout << "Clusters: " << clusterCount << " (" << polishMoves << " border moves)" << std::endl;
+    std::cout << "-----------------" << std::endl;
 }
 
 // Print graphics
@@ -162,7 +1166,10 @@ void DataSet::printGraph()
 
     // Connect callbacks to gtk container
     g_signal_connect(G_OBJECT(darea), "draw", G_CALLBACK(on_draw_event), NULL);
-    g_signal_connect(window, "destroy", G_CALLBACK(gtk_main_quit), NULL);
+    g_signal_connect(window, "destroy", G_CALLBACK(on_destroy), NULL);
+
+    // Redraw when the solver publishes a new snapshot
+    guint timer = g_timeout_add(100, on_timer, darea);
 
     // Setup gtk window params
     gtk_window_set_position(GTK_WINDOW(window), GTK_WIN_POS_CENTER);
@@ -175,60 +1182,250 @@ void DataSet::printGraph()
     
     // Start gtk main
     gtk_main();
+    g_source_remove(timer);
+
+    // Drop cached surfaces
+    if(view.layer)
+        cairo_surface_destroy(view.layer);
+    if(view.sprite)
+        cairo_surface_destroy(view.sprite);
+    view = View();
 }
 
 // Do drawing event for GTK
 static gboolean on_draw_event(GtkWidget *widget, cairo_t *cr, gpointer user_data)
 {
-    do_drawing(cr);
+    do_drawing(cr, gtk_widget_get_allocated_width(widget), gtk_widget_get_allocated_height(widget));
     return FALSE;
 }
 
+// Queue a redraw if the snapshot changed since the last tick
+static gboolean on_timer(gpointer widget)
+{
+    static std::shared_ptr<const Snapshot> shown;
+    std::shared_ptr<const Snapshot> current = ds.latest();
+    if(current != shown)
+    {
+        shown = current;
+        gtk_widget_queue_draw(GTK_WIDGET(widget));
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+// Window closed, stop the solver and leave gtk main
+static void on_destroy(GtkWidget *widget, gpointer user_data)
+{
+    stopRequested = true;
+    gtk_main_quit();
+}
+
 // Draw stuff on GTK window using cairo
-static void do_drawing(cairo_t* cr)
+static void do_drawing(cairo_t* cr, int width, int height)
 {
-    int scale = 4;
-    if(ds.cities.size() > 10)
-        scale = 5;
+    // Solver thread owns cheapestTour, draw from its last snapshot instead
+    std::shared_ptr<const Snapshot> shot = ds.latest();
+    bool detailed = ds.xs.size() <= detailLimit;
+
+    // Background (and cities when fast) come from the cached layer
+    update_view(cr, width, height);
+    if(view.layer)
+    {
+        cairo_set_source_surface(cr, view.layer, 0, 0);
+        cairo_paint(cr);
+    }
+    else
+    {
+        cairo_set_source_rgb(cr, 0.8, 0.8, 0.8);
+        cairo_paint(cr);
+    }
 
-    cairo_set_source_rgb(cr, 0.8, 0.8, 0.8);
-    cairo_paint(cr);
-    cairo_set_source_rgb(cr, 0, 0, 0);
     cairo_select_font_face (cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
 
     // Print all links
-    for(auto & link : ds.cheapestTour.tour)
+    if(shot)
+        draw_tour(cr, *shot);
+
+    // Print all cities over the links when there are few enough to label
+    if(detailed)
+        draw_labeled_cities(cr);
+
+    if(!shot)
+        return;
+
+    // Convergence readout in the corner
+    draw_convergence(cr, *shot);
+    
+    // Setup text format
+    cairo_set_font_size (cr, 35.0);
+
+    // Setup spacer and algorithm strings (upper case copy, the solver reads algorithm)
+    std::string spacer = "                   ";
+    std::string algorithm = ds.algorithm;
+    std::transform(algorithm.begin(), algorithm.end(), algorithm.begin(), toupper);
+
+    // Final snapshot is published after cheapestTour is complete
+    double runtime = shot->done ? ds.cheapestTour.time : shot->time;
+    
+    // Setup cheapest tour string
+    std::string cheapestTourString = "Algorithm: " + algorithm;
+    cheapestTourString.append(spacer + "File: " + ds.filename);
+    cheapestTourString.append(spacer + "Cost: " + toStrMaxDecimals(shot->cost, 2));
+    cheapestTourString.append(spacer + "Runtime: " + toStrMaxDecimals(runtime, 2) + " ms");
+
+    // Print string and format it
+    cairo_move_to (cr, 15, gdk_screen_height() - 90);
+    cairo_text_path(cr, cheapestTourString.c_str());
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    cairo_fill_preserve(cr);
+
+    // Print border on string
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_set_line_width(cr, 1.56);
+    cairo_stroke(cr);
+}
+
+// Map cities to pixels and rebuild cached surfaces after a resize
+static void update_view(cairo_t* cr, int width, int height)
+{
+    if(view.sprite && width == view.width && height == view.height)
+        return;
+
+    bool detailed = ds.xs.size() <= detailLimit;
+    view.width = width;
+    view.height = height;
+
+    // Few cities keep the fixed scale, many are fit to the window above the text line
+    if(detailed)
     {
-        cairo_move_to(cr, link.a.x * scale, link.a.y * scale);
-        cairo_line_to(cr, link.b.x * scale, link.b.y * scale);
-        cairo_stroke(cr);
+        view.scale = ds.xs.size() > 10 ? 5 : 4;
+        view.offsetX = 0;
+        view.offsetY = 0;
     }
+    else
+    {
+        float minX = *std::min_element(ds.xs.begin(), ds.xs.end());
+        float maxX = *std::max_element(ds.xs.begin(), ds.xs.end());
+        float minY = *std::min_element(ds.ys.begin(), ds.ys.end());
+        float maxY = *std::max_element(ds.ys.begin(), ds.ys.end());
+
+        double margin = 20, usableWidth = std::max(1.0, width - 2 * margin), usableHeight = std::max(1.0, height - 2 * margin - 120);
+        view.scale = std::min(usableWidth / std::max(maxX - minX, 1e-6f), usableHeight / std::max(maxY - minY, 1e-6f));
+        view.offsetX = margin - minX * view.scale;
+        view.offsetY = margin - minY * view.scale;
+    }
+
+    // One sprite for every city, a shaded disc or a small dot
+    if(view.sprite)
+        cairo_surface_destroy(view.sprite);
+    view.spriteRadius = detailed ? 11 : 1.5;
+    int size = (int) std::ceil(2 * view.spriteRadius);
+    view.sprite = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size, size);
 
-    // Print all cities 
-    for(auto & city : ds.cities)
+    cairo_t* pen = cairo_create(view.sprite);
+    if(detailed)
     {
-        // Create gradient for cities
-        cairo_pattern_t* r1;
-        r1 = cairo_pattern_create_radial(city.x * scale, city.y * scale, 3, city.x * scale, city.y * scale, 11);  
+        cairo_pattern_t* r1 = cairo_pattern_create_radial(view.spriteRadius, view.spriteRadius, 3, view.spriteRadius, view.spriteRadius, 11);
         cairo_pattern_add_color_stop_rgba(r1, 0, 1, 1, 1, 1);
         cairo_pattern_add_color_stop_rgba(r1, 1, 0.6, 0.6, 0.6, 1);
+        cairo_set_source(pen, r1);
+        cairo_pattern_destroy(r1);
+    }
+    else
+        cairo_set_source_rgb(pen, 0.3, 0.3, 0.3);
+    cairo_arc(pen, view.spriteRadius, view.spriteRadius, view.spriteRadius, 0, 2*M_PI);
+    cairo_fill(pen);
+    cairo_destroy(pen);
+
+    // Static layer only pays off when there are too many cities to redraw
+    if(view.layer)
+        cairo_surface_destroy(view.layer);
+    view.layer = NULL;
+    if(detailed)
+        return;
+
+    view.layer = cairo_surface_create_similar(cairo_get_target(cr), CAIRO_CONTENT_COLOR, width, height);
+    pen = cairo_create(view.layer);
+    cairo_set_source_rgb(pen, 0.8, 0.8, 0.8);
+    cairo_paint(pen);
+
+    // One sprite per pixel, cities landing on a covered pixel are culled
+    std::vector<char> covered((size_t) width * height, 0);
+    for(unsigned int id = 0; id < ds.xs.size(); id++)
+    {
+        int x = (int) (ds.xs[id] * view.scale + view.offsetX);
+        int y = (int) (ds.ys[id] * view.scale + view.offsetY);
+        if(x < 0 || y < 0 || x >= width || y >= height || covered[(size_t) y * width + x])
+            continue;
+
+        covered[(size_t) y * width + x] = 1;
+        cairo_set_source_surface(pen, view.sprite, x - view.spriteRadius, y - view.spriteRadius);
+        cairo_paint(pen);
+    }
+    cairo_destroy(pen);
+}
+
+// Whole tour as one path, points within cullPixels of the last one dropped
+static void draw_tour(cairo_t* cr, const Snapshot& shot)
+{
+    bool detailed = shot.order.size() <= detailLimit;
+    double lastX = 0, lastY = 0;
+
+    cairo_new_path(cr);
+    for(size_t i = 0; i < shot.order.size(); i++)
+    {
+        unsigned int id = shot.order[i];
+        double x = ds.xs[id] * view.scale + view.offsetX;
+        double y = ds.ys[id] * view.scale + view.offsetY;
+
+        if(i == 0)
+            cairo_move_to(cr, x, y);
+        else if(detailed || std::fabs(x - lastX) >= cullPixels || std::fabs(y - lastY) >= cullPixels || i + 1 == shot.order.size())
+            cairo_line_to(cr, x, y);
+        else
+            continue;
+
+        lastX = x;
+        lastY = y;
+    }
+    cairo_close_path(cr);
+
+    // Thin aliased lines are much cheaper to rasterize at this density
+    cairo_save(cr);
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_set_line_width(cr, detailed ? 2 : 1);
+    if(!detailed)
+    {
+        cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
+        cairo_set_line_join(cr, CAIRO_LINE_JOIN_BEVEL);
+    }
+    cairo_stroke(cr);
+    cairo_restore(cr);
+}
+
+// Shaded city sprites with their numbers
+static void draw_labeled_cities(cairo_t* cr)
+{
+    cairo_set_font_size (cr, 18.0);
+    for(unsigned int id = 0; id < ds.xs.size(); id++)
+    {
+        double x = ds.xs[id] * view.scale + view.offsetX;
+        double y = ds.ys[id] * view.scale + view.offsetY;
 
         // Paint city
-        cairo_set_source(cr, r1);
-        cairo_arc(cr, city.x * scale, city.y * scale, 11, 0, 2*M_PI);
-        cairo_fill(cr); 
+        cairo_set_source_surface(cr, view.sprite, x - view.spriteRadius, y - view.spriteRadius);
+        cairo_paint(cr);
 
         // Print city num
-        cairo_set_font_size (cr, 18.0);
         cairo_set_source_rgb(cr, 1, 1, 1);
 
-        if(city.num < 10)
-            cairo_move_to(cr, city.x * scale - 5.5, city.y * scale + 5.5);
+        if(id + 1 < 10)
+            cairo_move_to(cr, x - 5.5, y + 5.5);
         else
-            cairo_move_to(cr, city.x * scale - 9.0, city.y * scale + 5.5);
+            cairo_move_to(cr, x - 9.0, y + 5.5);
 
         std::string name = "";
-        name.append(toStrMaxDecimals(city.num, 0));
+        name.append(toStrMaxDecimals(ds.cityLabel(id + 1), 0));
         cairo_text_path(cr, name.c_str());
         cairo_fill_preserve(cr);
     
@@ -237,30 +1434,61 @@ static void do_drawing(cairo_t* cr)
         cairo_set_line_width(cr, 0.70);
         cairo_stroke(cr);
     }
-    
-    // Setup text format
-    cairo_set_font_size (cr, 35.0);
+}
 
-    // Setup spacer and algorithm strings
-    std::string spacer = "                   ";
-    std::transform(ds.algorithm.begin(), ds.algorithm.end(), ds.algorithm.begin(), toupper);
-    
-    // Setup cheapest tour string
-    std::string cheapestTourString = "Algorithm: " + ds.algorithm;
-    cheapestTourString.append(spacer + "File: " + ds.filename);
-    cheapestTourString.append(spacer + "Cost: " + toStrMaxDecimals(ds.cheapestTour.cost, 2));
-    cheapestTourString.append(spacer + "Runtime: " + toStrMaxDecimals(ds.cheapestTour.time, 2) + " ms");
+// Cost over time sparkline with step, best cost and improvement
+static void draw_convergence(cairo_t* cr, const Snapshot& shot)
+{
+    const double width = 420, height = 150, pad = 12;
+    double left = gdk_screen_width() - width - 20, top = 20;
 
-    // Print string and format it
-    cairo_move_to (cr, 15, gdk_screen_height() - 90);
-    cairo_text_path(cr, cheapestTourString.c_str());
-    cairo_set_source_rgb(cr, 1, 1, 1);
-    cairo_fill_preserve(cr);
+    // Panel
+    cairo_set_source_rgba(cr, 1, 1, 1, 0.85);
+    cairo_rectangle(cr, left, top, width, height);
+    cairo_fill(cr);
+
+    // Curve scaled to the cost range seen so far
+    const std::vector<std::pair<double, float>>& points = shot.history;
+    if(points.size() > 1)
+    {
+        float high = points.front().second, low = points.front().second;
+        for(auto & point : points)
+        {
+            high = std::max(high, point.second);
+            low = std::min(low, point.second);
+        }
+
+        double span = std::max(points.back().first - points.front().first, 1e-9);
+        double range = std::max((double) high - low, 1e-9);
+        double plotWidth = width - 2 * pad, plotHeight = height - 3 * pad - 18;
+
+        cairo_set_source_rgb(cr, 0.1, 0.4, 0.8);
+        cairo_set_line_width(cr, 2);
+        for(size_t i = 0; i < points.size(); i++)
+        {
+            double x = left + pad + (points[i].first - points.front().first) / span * plotWidth;
+            double y = top + pad + (high - points[i].second) / range * plotHeight;
+            if(i == 0)
+                cairo_move_to(cr, x, y);
+            else
+                cairo_line_to(cr, x, y);
+        }
+        cairo_stroke(cr);
+    }
+
+    // Readout
+    double first = points.empty() ? shot.cost : points.front().second;
+    double gain = first > 0 ? (first - shot.cost) / first * 100 : 0;
+    std::string readout = "Step: " + std::to_string(shot.step);
+    readout.append("   Best: " + toStrMaxDecimals(shot.cost, 2));
+    readout.append("   -" + toStrMaxDecimals(gain, 2) + "%");
+    readout.append(shot.done ? "   done" : "   running");
 
-    // Print border on string
     cairo_set_source_rgb(cr, 0, 0, 0);
-    cairo_set_line_width(cr, 1.56);
-    cairo_stroke(cr);
+    cairo_set_font_size(cr, 16.0);
+    cairo_move_to(cr, left + pad, top + height - pad);
+    cairo_text_path(cr, readout.c_str());
+    cairo_fill(cr);
 }
 
 // Format string to dec places provided
@@ -281,88 +1509,91 @@ static std::string toStrMaxDecimals(double value, int decimals)
 // Nearest neighbor algorithm
 void DataSet::greedy()
 {
-    // Start clock
-    cheapestTour.time = clock();
+    // Starts run in parallel, so time on the wall clock
+    double start = elapsed();
 
-    // Generate greedy solution from every possible start
-    for(unsigned int i = 0; i < cities.size(); i++)
+    // Cost of every start on the pool, each task with its own visited mask
+    std::vector<float> costs(cities.size());
+    ThreadPool::instance().parallelFor(0, cities.size(), [&](unsigned int i)
     {
-        // Only clear after first iteration
-        tempTour.tour.clear();
-        tempTour.cost = 0;
+        std::vector<unsigned int> mask;
+        costs[i] = greedyWalk(i, mask, NULL);
+    });
 
-        // Reset all cities visited status
-        for(unsigned int j = 0; j < cities.size(); j++)
-            cities.at(j).added = false;
+    // First of the cheapest starts, as the serial sweep picked it
+    unsigned int best = std::min_element(costs.begin(), costs.end()) - costs.begin();
+    if(!cities.empty())
+    {
+        cheapestTour.tour.clear();
+        cheapestTour.cost = greedyWalk(best, visited, &cheapestTour.tour);
+        publish(cheapestTour, cities.size());
+    }
 
-        // Add first edge
-        cities.at(i).added = true;
-        findClosestCity(cities.at(i));
- 
-        // Add rest of edges
-        while(!allCitiesAdded())
-            findClosestCity(tempTour.tour.back().b);
+    cheapestTour.time = elapsed() - start;
 
-        // Push final edge
-        tempTour.tour.push_back(Link(tempTour.tour.back().b, cities.at(i)));
+    // Tours calculated is city count
+    this->tourCount = cities.size();
+}
 
-        // Calculate final cost
-        for(auto & link : tempTour.tour)
-            tempTour.cost += link.distance;
+// Nearest neighbor tour from cities[start] marking the caller's mask
+float DataSet::greedyWalk(unsigned int start, std::vector<unsigned int>& mask, LinkList* links)
+{
+    mask.assign((cities.size() + 31) / 32, 0);
+    City from = cities.at(start);
+    mask[(from.num - 1) >> 5] |= 1u << ((from.num - 1) & 31);
 
-        // If this tour cheaper than current cheapest, replace it
-        if(cheapestTour.cost == 0 || tempTour.cost < cheapestTour.cost)
-            cheapestTour = tempTour;
+    // Summed link by link, in the order the links are made
+    float cost = 0;
+    for(unsigned int added = 1; added < cities.size(); added++)
+    {
+        unsigned int id = nearestUnvisited(xs.data(), ys.data(), cities.size(), mask.data(), from.x, from.y);
+        mask[id >> 5] |= 1u << (id & 31);
+
+        Link link(from, City(xs[id], ys[id], id + 1));
+        cost += link.distance;
+        if(links)
+            links->push_back(link);
+        from = link.b;
     }
 
-    // Subtract current time from cheapestTour time
-    cheapestTour.time -= clock();
+    // Back to the start
+    Link last(from, cities.at(start));
+    cost += last.distance;
+    if(links)
+        links->push_back(last);
 
-    // Divide time by CPS to get time in secs
-    cheapestTour.time /= (double) CLOCKS_PER_SEC;
-
-    // Time is currently negative so flip sign and convert to ms
-    cheapestTour.time *= -1000;
-
-    // Tours calculated is city count
-    this->tourCount = cities.size();
+    return cost;
 }
 
 // All cities added
 bool DataSet::allCitiesAdded()
 {
-    for(auto & city : cities)
-        if(!city.added)
-            return false;
-    
-    return true;
+    return visitedCount >= cities.size();
+}
+
+// Clear visited bitmask
+void DataSet::resetVisited()
+{
+    visited.assign((cities.size() + 31) / 32, 0);
+    visitedCount = 0;
+}
+
+// Set visited bit for id
+void DataSet::markVisited(unsigned int id)
+{
+    visited[id >> 5] |= 1u << (id & 31);
+    visitedCount++;
 }
 
 // Find closest city to city
 void DataSet::findClosestCity(City c1)
 {
-    Link cheapestLink;
-    unsigned int cheapestCity = 0;
-
-    // Iterate over cities
-    for(unsigned int i = 0; i < cities.size(); i++)
-    {
-        // If this edge is cheaper, replace cheapest and its not itself
-        if(!cities.at(i).added)
-        {
-            Link temp = Link(c1, cities.at(i));
-        
-            if(cheapestLink.distance == -1 || temp.distance < cheapestLink.distance)
-            {
-                cheapestLink = temp;
-                cheapestCity = i;
-            }
-        }
-    }
+    // Vectorized scan over unvisited cities
+    unsigned int id = nearestUnvisited(xs.data(), ys.data(), cities.size(), visited.data(), c1.x, c1.y);
 
-    // Print cheapest link
-    cities.at(cheapestCity).added = true;
-    tempTour.tour.push_back(cheapestLink);
+    // Add cheapest link
+    markVisited(id);
+    tempTour.tour.push_back(Link(c1, City(xs[id], ys[id], id + 1)));
 }
 
 // Genetic algorithm
@@ -372,28 +1603,90 @@ void DataSet::genetic()
     //std::srand(std::time(0));
     //cheapestTour.time = clock();
 
-    // Initialize Population
-    initPop();
+    // Initialize Population, unless a checkpoint brought one back
+    double mark = elapsed();
+    resumeCheckpoint();
+
+    // Adaptive runs each start from the configured settings, a resumed
+    // population keeps what its run had adapted
+    if(adaptive && !resumePending)
+        startAdaptive();
+
+    if(resumePending)
+    {
+        resumePending = false;
+        rehashPop(false);
+    }
+    else
+    {
+        initPop();
+        rehashPop(true);
+    }
+    initTime += lap(mark);
+
+    // Children get local search over the candidate lists
+    searchers.clear();
+    if(memetic)
+        buildCandidates(10);
+
+    if(!checkpointPath.empty() && !checkpointer)
+        checkpointer = std::make_shared<CheckpointWriter>(checkpointPath);
+    lastCheckpoint = elapsed();
+
+    // Each run gets its own run number in the trace
+    if(!tracePath.empty() && !tracer)
+        tracer = std::make_shared<TraceSink>(tracePath);
+    traceRuns++;
+    tracedGeneration = -1;
+    crossTried = crossAccepted = mutateTried = mutateAccepted = 0;
 
     // Repeat gen times
-    while(genCount < 200000)
+    while(genCount < 200000 && !outOfTime())
     {
         // Sort pop
         sortPop();
+        sortTime += lap(mark);
+        publish(population.at(0), genCount);
+        if(tracer && genCount % traceEvery == 0)
+            traceGeneration();
+        if(adaptive)
+            adaptPop();
+
+        // Close enough to the lower bound
+        if(gapReached(population.at(0).cost))
+            break;
 
         // Crossover random parents, prune weakest
         crossPop();
+        crossTime += lap(mark);
 
         // Mutate according to mutateFactor
         mutatePop();
+        mutateTime += lap(mark);
 
         // Update gen count
         genCount++;
+
+        // Snapshot now and then, the writer thread does the disk work
+        if(checkpointer && elapsed() - lastCheckpoint >= checkpointInterval)
+            saveCheckpoint();
     }
 
     // Final sort
     sortPop();
 
+    if(tracer)
+    {
+        traceGeneration();
+        tracer->flush();
+    }
+
+    if(checkpointer)
+    {
+        saveCheckpoint();
+        checkpointer->flush();
+    }
+
     // Make fittest individual in population our solution
     //cheapestTour = population.at(0);
 
@@ -410,19 +1703,64 @@ void DataSet::genetic()
 // Initializes population for GA
 void DataSet::initPop()
 {
+    unsigned int remaining = 0;
+    if(cities.size() < popSize)
+        remaining = popSize - cities.size();
+
+    // Curve, construction and warm start seeding do not scale the population with the city count
+    unsigned int starts = cities.size();
+    if(initMethod.compare("greedy") != 0 || warmStarted())
+    {
+        starts = 0;
+        remaining = popSize;
+    }
+
+    unsigned int slots = starts + remaining;
+    allocPop(slots);
+
+    // Previous tour and kicked copies of it
+    if(warmStarted())
+    {
+        initPopSeeded(std::vector<std::vector<unsigned int>>(1, warmOrder));
+        return;
+    }
+
+    // Space filling curve tours instead of greedy and random ones
+    if(initMethod.compare("sfc") == 0)
+    {
+        std::vector<std::vector<unsigned int>> variants;
+        for(unsigned int v = 0; v < 8 && v < slots; v++)
+            variants.push_back(hilbertOrder(xs, ys, v));
+        initPopSeeded(variants);
+        return;
+    }
+
+    // Construction heuristic tour
+    if(initMethod.compare("greedy") != 0)
+    {
+        buildCandidates(10);
+        std::vector<std::vector<unsigned int>> variants(1, constructTour(initMethod, xs, ys, candidates, candidateK));
+        if(variants[0].size() != cities.size())
+        {
+            std::cout << "Unknown init method: " << initMethod << std::endl;
+            variants[0] = hilbertOrder(xs, ys);
+        }
+        initPopSeeded(variants);
+        return;
+    }
+
     // Generate greedy solution from every possible start
-    for(unsigned int i = 0; i < cities.size(); i++)
+    for(unsigned int i = 0; i < starts; i++)
     {
         // Only clear after first iteration
         tempTour.tour.clear();
         tempTour.cost = 0;
 
         // Reset all cities visited status
-        for(unsigned int j = 0; j < cities.size(); j++)
-            cities.at(j).added = false;
+        resetVisited();
 
         // Add first edge
-        cities.at(i).added = true;
+        markVisited(cities.at(i).num - 1);
         findClosestCity(cities.at(i));
  
         // Add rest of edges
@@ -433,31 +1771,70 @@ void DataSet::initPop()
         tempTour.tour.push_back(Link(tempTour.tour.back().b, cities.at(i)));
 
         // Calculate final cost
-        for(auto & link : tempTour.tour)
-            tempTour.cost += link.distance;
+        tempTour.cost = tourCost(tempTour);
 
-        population.push_back(tempTour);
+        // Copy into slot storage
+        population.at(i).tour = tempTour.tour;
+        population.at(i).cost = tempTour.cost;
     }
 
-    unsigned int remaining = 0;
-    if(cities.size() < popSize)
-        remaining = popSize - cities.size();
-
-    Tour temp;
-    for(unsigned int i = 0; i < remaining; i++)
+    for(unsigned int i = cities.size(); i < slots; i++)
     {
+        Tour& temp = population.at(i);
         temp.tour.clear();
         temp.cost = 0;
-        std::random_shuffle(cities.begin(), cities.end());
+        std::shuffle(cities.begin(), cities.end(), rng);
         for(unsigned int j = 0; j < cities.size() - 1; j++)
             temp.tour.push_back(Link(cities.at(j), cities.at(j+1)));
 
         temp.tour.push_back(Link(temp.tour.back().b, cities.at(0)));
 
-        for(Link link : temp.tour)
-            temp.cost += link.distance;
+        temp.cost = tourCost(temp);
+    }
+}
+
+// Every individual gets one arena slot for the whole run
+void DataSet::allocPop(unsigned int slots)
+{
+    // Adaptive runs may grow the population to twice its size, batches need their child slots
+    unsigned int capacity = (adaptive ? 2 * slots : slots) + (batch ? batchCount(2 * slots) : 0);
+    population.clear();
+    offspring.clear();
+    if(!arena || arena->blockLinks != cities.size() || arena->slots < capacity)
+        arena = std::make_shared<TourArena>(capacity, cities.size());
+
+    population.reserve(capacity);
+    population.resize(slots);
+    for(auto & tour : population)
+    {
+        tour.tour = LinkList(ArenaAllocator<Link>(arena.get()));
+        tour.tour.reserve(cities.size());
+    }
+    crossScratch.cities.reserve(cities.size());
+    crossScratch.spots.reserve(cities.size());
+}
 
-        population.push_back(temp);
+// Population from seed tours, copies past the seeds get short random reversals
+void DataSet::initPopSeeded(const std::vector<std::vector<unsigned int>>& variants)
+{
+    std::vector<unsigned int> order;
+    unsigned int n = cities.size();
+
+    for(unsigned int i = 0; i < population.size(); i++)
+    {
+        order = variants.at(i % variants.size());
+
+        // Beyond the plain variants, kick with a few local reversals
+        for(unsigned int kick = 0; i >= variants.size() && kick < 3 && n > 3; kick++)
+        {
+            unsigned int start = rng() % n;
+            unsigned int length = 2 + rng() % std::min(n - 1, 50u);
+            if(start + length > n)
+                start = n - length;
+            std::reverse(order.begin() + start, order.begin() + start + length);
+        }
+
+        buildTour(order, population.at(i));
     }
 }
 
@@ -467,11 +1844,11 @@ void DataSet::printPop()
     int i = 0;
     for(auto & tour : population)
     {
-        std::cout << std::setfill('0') << std::setw(3) << i << ") [ " << tour.tour.at(0).a.num << " ";
+        std::cout << std::setfill('0') << std::setw(3) << i << ") [ " << cityLabel(tour.tour.at(0).a.num) << " ";
 
         // Print links from tour
         for(auto & link : tour.tour)
-            std::cout << link.b.num << " ";
+            std::cout << cityLabel(link.b.num) << " ";
 
         std::cout << "]: $" << toStrMaxDecimals(tour.cost, 2) << std::endl;
         i++;
@@ -488,40 +1865,290 @@ void DataSet::sortPop()
 // Crossover population
 void DataSet::crossPop()
 {
-    int rand1, rand2;
-    int children = 3;
+    if(batch)
+    {
+        crossPopBatch();
+        return;
+    }
+
+    unsigned int children = childCount;
+
+    // Weakest parents are killed off, children reuse their slots
+    unsigned int survivors = population.size() - children;
+
+    // Memetic children are bred, improved together, then checked for copies
+    if(memetic)
+    {
+        std::vector<int> used(children);
+        for(unsigned int i = 0; i < children; i++)
+        {
+            Tour& child = population.at(survivors + i);
+            dropHash(child.hash);
+            used[i] = breed(child, survivors);
+        }
+
+        improveChildren(survivors, population.size());
+
+        // Children often share a local optimum, kick copies apart
+        for(unsigned int i = 0; i < children; i++)
+        {
+            Tour& child = population.at(survivors + i);
+            child.hash = edgeHash.tour(child.tour);
+            for(unsigned int attempt = 0; hashCounts.count(child.hash) && attempt <= duplicateRetries; attempt++)
+            {
+                duplicatesRejected++;
+                kick(child);
+            }
+            addHash(child.hash);
+            countChild(child, survivors, used[i]);
+        }
+        return;
+    }
+
+    for(unsigned int i = 0; i < children; i++)
+    {
+        // Slot's old tour leaves the population
+        Tour& child = population.at(survivors + i);
+        dropHash(child.hash);
+        int used = cross;
+
+        // Retry crossover on a duplicate, then kick the child until it is new
+        for(unsigned int attempt = 0; ; attempt++)
+        {
+            if(attempt <= duplicateRetries)
+            {
+                used = breed(child, survivors);
+                child.hash = edgeHash.tour(child.tour);
+            }
+            else
+                kick(child);
+
+            // Keep only edge sets the population does not have yet
+            if(!hashCounts.count(child.hash) || attempt > 2 * duplicateRetries)
+                break;
+            duplicatesRejected++;
+        }
+
+        addHash(child.hash);
+        countChild(child, survivors, used);
+    }
+}
+
+// Child counts as accepted if it beats the weakest survivor, how far it
+// beats it is the crossover's reward
+void DataSet::countChild(const Tour& child, unsigned int survivors, int op)
+{
+    float weakest = population.at(survivors - 1).cost;
+    childrenBred++;
+    crossTried++;
+    if(child.cost < weakest)
+        crossAccepted++;
+    if(adaptive)
+        crossSelector.reward(op - 1, std::max(0.0f, weakest - child.cost) / weakest);
+}
+
+// Batch size, at least one child and never the whole population
+unsigned int DataSet::batchCount(unsigned int size)
+{
+    unsigned int count = batchSize > 0 ? batchSize : size / 2;
+    return std::max(1u, std::min(count, size - 1));
+}
+
+// Tasks breed fixed strides of the batch with their own seeded random
+// numbers, so a run repeats whatever the thread timing
+void DataSet::crossPopBatch()
+{
+    unsigned int count = batchCount(population.size());
+    unsigned int survivors = population.size();
+
+    // Child slots draw from the arena like population slots
+    while(offspring.size() < count)
+    {
+        offspring.push_back(Tour());
+        offspring.back().tour = LinkList(ArenaAllocator<Link>(arena.get()));
+        offspring.back().tour.reserve(cities.size());
+    }
+    offspring.resize(count);
+
+    // Operators and task seeds come from the GA stream
+    std::vector<int> used(count);
+    for(auto & op : used)
+        op = adaptive ? crossSelector.pick(rng) + 1 : cross;
+
+    unsigned int workers = std::max(1u, std::min(count, ThreadPool::instance().size()));
+    breeders.resize(workers);
+    for(auto & breeder : breeders)
+        breeder.rng.seed(rng());
+
+    while(memetic && searchers.size() < workers)
+        searchers.push_back(std::make_shared<LocalSearch>(xs, ys, candidates, candidateK));
+    std::vector<unsigned long> moves(workers, 0), rejected(workers, 0);
+
+    // Population and hashCounts are only read until the merge. Copies of a
+    // member are retried and kicked as in crossPop
+    auto work = [&](unsigned int t)
+    {
+        Breeder& breeder = breeders[t];
+        std::vector<unsigned int> order;
+        for(unsigned int c = t; c < count; c += workers)
+        {
+            Tour& child = offspring[c];
+            for(unsigned int attempt = 0; ; attempt++)
+            {
+                if(attempt <= duplicateRetries && (attempt == 0 || !memetic))
+                {
+                    unsigned int rand1, rand2;
+                    pickParents(survivors, breeder.rng, rand1, rand2);
+                    crossover(population[rand1], population[rand2], child, used[c], breeder.scratch, breeder.rng);
+
+                    if(memetic)
+                    {
+                        LocalSearch& search = *searchers[t];
+                        search.maxMoves = memeticMoves;
+                        order.clear();
+                        for(auto & link : child.tour)
+                            order.push_back(link.a.num - 1);
+
+                        search.optimize(order);
+                        moves[t] += search.moves;
+                        buildTour(order, child);
+                    }
+                    child.hash = edgeHash.tour(child.tour);
+                }
+                else
+                    kick(child, breeder.rng);
+
+                if(!hashCounts.count(child.hash) || attempt > 2 * duplicateRetries)
+                    break;
+                rejected[t]++;
+            }
+        }
+    };
+
+    ThreadPool::instance().parallelFor(0, workers, work, 1);
+    for(unsigned long total : rejected)
+        duplicatesRejected += total;
 
-    // Kill off weakest parents
-    population.resize(population.size() - children);
-    for(int i = 0; i < children; i++)
+    if(memetic)
     {
-        rand1 = rand() % popSize % (population.size() - 1);
+        memeticChildren += count;
+        for(unsigned long total : moves)
+            memeticMoveCount += total;
+    }
+
+    // Credit against the population as it was bred from
+    for(unsigned int c = 0; c < count; c++)
+        countChild(offspring[c], survivors, used[c]);
 
-        rand2 = rand() % (population.size() - 1);
-        while(rand2 == rand1)
-            rand2 = rand() % (population.size() - 1);
+    // Cheapest children first, each swaps with the weakest member it beats
+    std::vector<unsigned int> rank(count);
+    for(unsigned int c = 0; c < count; c++)
+        rank[c] = c;
+    std::sort(rank.begin(), rank.end(), [this](unsigned int a, unsigned int b) { return offspring[a].cost < offspring[b].cost; });
 
-        Tour child = crossover(population.at(rand1), population.at(rand2));
+    unsigned int weakest = survivors - 1;
+    for(unsigned int c : rank)
+    {
+        Tour& child = offspring[c];
+        if(weakest == 0 || child.cost >= population[weakest].cost)
+            break;
+        if(hashCounts.count(child.hash))
+        {
+            duplicatesRejected++;
+            continue;
+        }
 
-        // Assimilate children into population
-        population.push_back(child);
+        dropHash(population[weakest].hash);
+        std::swap(population[weakest], child);
+        addHash(population[weakest].hash);
+        weakest--;
     }
 }
 
+// Parents from the survivors, returns the crossover used
+int DataSet::breed(Tour& child, unsigned int survivors)
+{
+    unsigned int rand1, rand2;
+    pickParents(survivors, rng, rand1, rand2);
+
+    // Adaptive runs draw the crossover per child
+    int op = adaptive ? crossSelector.pick(rng) + 1 : cross;
+
+    // Assimilate children into population
+    crossover(population.at(rand1), population.at(rand2), child, op, crossScratch, rng);
+    return op;
+}
+
+// First parent index folds popSize onto the survivors, fitter ones more often
+void DataSet::pickParents(unsigned int survivors, std::mt19937& random, unsigned int& rand1, unsigned int& rand2)
+{
+    rand1 = random() % popSize % (survivors - 1);
+
+    rand2 = random() % (survivors - 1);
+    while(rand2 == rand1)
+        rand2 = random() % (survivors - 1);
+}
+
+// Children pulled by pool tasks, each with its own local search
+void DataSet::improveChildren(unsigned int first, unsigned int last)
+{
+    unsigned int workers = std::max(1u, std::min(last - first, ThreadPool::instance().size()));
+    while(searchers.size() < workers)
+        searchers.push_back(std::make_shared<LocalSearch>(xs, ys, candidates, candidateK));
+
+    std::atomic<unsigned int> taken(first);
+    std::vector<unsigned long> moves(workers, 0);
+
+    // Slots keep their arena storage, buildTour never reallocates
+    auto work = [&](unsigned int t)
+    {
+        LocalSearch& search = *searchers[t];
+        search.maxMoves = memeticMoves;
+
+        std::vector<unsigned int> order;
+        for(unsigned int c = taken++; c < last; c = taken++)
+        {
+            Tour& child = population.at(c);
+            order.clear();
+            for(auto & link : child.tour)
+                order.push_back(link.a.num - 1);
+
+            search.optimize(order);
+            moves[t] += search.moves;
+            buildTour(order, child);
+        }
+    };
+
+    ThreadPool::instance().parallelFor(0, workers, work, 1);
+
+    memeticChildren += last - first;
+    for(unsigned long count : moves)
+        memeticMoveCount += count;
+}
+
 // Mutate population (according to mutate factor
 void DataSet::mutatePop()
 {
-    if(mutate == 1)
+    // Adaptive runs draw the mutator each generation
+    int op = adaptive ? mutateSelector.pick(rng) + 1 : mutate;
+
+    if(op == 1)
     {
         // If random value falls within mutateFactor
-        if(((double) rand() / RAND_MAX) < mutateFactor)
+        if(((double) rng() / rng.max()) < mutateFactor)
         {
-            int popIndex = rand() %  population.size();
-            int cityIndex1 = (rand() % (cities.size() - 2)) + 1;
+            int popIndex = rng() %  population.size();
+            int cityIndex1 = (rng() % (cities.size() - 2)) + 1;
 
-            int cityIndex2 = (rand() % (cities.size() - 2)) + 1;
+            int cityIndex2 = (rng() % (cities.size() - 2)) + 1;
             while(cityIndex2 == cityIndex1)
-                cityIndex2 = (rand() % (cities.size() - 2)) + 1;
+                cityIndex2 = (rng() % (cities.size() - 2)) + 1;
+
+            // Changing links come out of the hash
+            Tour& tour = population.at(popIndex);
+            float before = tour.cost;
+            dropHash(tour.hash);
+            xorLinks(tour, { cityIndex1, cityIndex1 + 1, cityIndex2, cityIndex2 + 1 });
             
             // Swap
             City temp = population.at(popIndex).tour.at(cityIndex1).b;
@@ -533,24 +2160,30 @@ void DataSet::mutatePop()
             population.at(popIndex).tour.at(cityIndex2 + 1).a = temp;
             population.at(popIndex).tour.at(cityIndex1 + 1).a = temp2;
 
-            // Update cost
-            population.at(popIndex).cost = 0.0;
-            for(unsigned int i = 0; i < cities.size(); i++)
-                population.at(popIndex).tour.at(i).dist(population.at(popIndex).tour.at(i).a, population.at(popIndex).tour.at(i).b);
-            
-            for(Link link : population.at(popIndex).tour)
-                population.at(popIndex).cost += link.distance;
+            // Update cost and hash, only four links changed
+            for(int i : { cityIndex1, cityIndex1 + 1, cityIndex2, cityIndex2 + 1 })
+                tour.tour.at(i).dist(tour.tour.at(i).a, tour.tour.at(i).b);
+            tour.cost = tourCost(tour);
+            xorLinks(tour, { cityIndex1, cityIndex1 + 1, cityIndex2, cityIndex2 + 1 });
+            addHash(tour.hash);
 
+            countMutation(tour, before, op);
             mutateCount++;
         }
     }
-    else if(mutate == 2)
+    else if(op == 2)
     {
         // If random value falls within mutateFactor
-        if(((double) rand() / RAND_MAX) < mutateFactor)
+        if(((double) rng() / rng.max()) < mutateFactor)
         {
-            int popIndex = rand() %  population.size();
-            int cityIndex = (rand() % (cities.size() - 2)) + 1;
+            int popIndex = rng() %  population.size();
+            int cityIndex = (rng() % (cities.size() - 2)) + 1;
+
+            // Changing links come out of the hash
+            Tour& tour = population.at(popIndex);
+            float before = tour.cost;
+            dropHash(tour.hash);
+            xorLinks(tour, { 0, cityIndex, cityIndex + 1, (int) cities.size() - 1 });
             
             // Swap
             City temp = population.at(popIndex).tour.at(0).a;
@@ -561,30 +2194,221 @@ void DataSet::mutatePop()
             population.at(popIndex).tour.at(cityIndex + 1).a = temp;
             population.at(popIndex).tour.back().b = population.at(popIndex).tour.front().a;
 
-            // Update cost
-            population.at(popIndex).cost = 0.0;
-            for(unsigned int i = 0; i < cities.size(); i++)
-                population.at(popIndex).tour.at(i).dist(population.at(popIndex).tour.at(i).a, population.at(popIndex).tour.at(i).b);
-            
-            for(Link link : population.at(popIndex).tour)
-                population.at(popIndex).cost += link.distance;
+            // Update cost and hash, only four links changed
+            for(int i : { 0, cityIndex, cityIndex + 1, (int) cities.size() - 1 })
+                tour.tour.at(i).dist(tour.tour.at(i).a, tour.tour.at(i).b);
+            tour.cost = tourCost(tour);
+            xorLinks(tour, { 0, cityIndex, cityIndex + 1, (int) cities.size() - 1 });
+            addHash(tour.hash);
 
+            countMutation(tour, before, op);
             mutateCount++;
         }
     }
 }
 
+// Settings of the first run are the base, selectors start fresh
+void DataSet::startAdaptive()
+{
+    if(basePopSize == 0)
+    {
+        basePopSize = popSize;
+        baseMutateFactor = mutateFactor;
+    }
+    popSize = basePopSize;
+    mutateFactor = baseMutateFactor;
+    childCount = 3;
+
+    crossSelector = OperatorSelector(2);
+    mutateSelector = OperatorSelector(2);
+    stallGenerations = 0;
+    stallBest = std::numeric_limits<float>::infinity();
+    popMax = 0;
+}
+
+// Stuck or converged runs explore: more mutation, more members. Improving
+// runs exploit: less mutation and a smaller population for more generations
+void DataSet::adaptPop()
+{
+    // Bounds come from the population the run built or resumed
+    if(popMax == 0)
+    {
+        startPopulation = population.size();
+        popMin = std::max(childCount + 10, startPopulation / 4);
+        popMax = std::max(startPopulation, std::min(arena->slots, 2 * startPopulation));
+    }
+
+    float best = population.front().cost;
+    if(best < stallBest)
+    {
+        stallBest = best;
+        stallGenerations = 0;
+    }
+    else
+        stallGenerations++;
+
+    if(genCount == 0 || genCount % adaptInterval != 0)
+        return;
+
+    // Cost spread stands in for diversity, copies are already kept out
+    double total = 0;
+    for(auto & tour : population)
+        total += tour.cost;
+    double spread = (total / population.size() - best) / best;
+
+    if(stallGenerations >= stallLimit || spread < 0.01)
+    {
+        mutateFactor = std::min(0.9, mutateFactor * 1.25);
+        growPop(std::min(popMax - (unsigned int) population.size(), (unsigned int) population.size() / 10 + 1));
+    }
+    else if(stallGenerations < adaptInterval)
+    {
+        mutateFactor = std::max(0.02, mutateFactor * 0.9);
+        shrinkPop(std::min((unsigned int) population.size() - popMin, (unsigned int) population.size() / 20));
+    }
+
+    // About 2% of the population is replaced each generation
+    popSize = population.size();
+    childCount = std::max(3u, (unsigned int) population.size() / 50);
+}
+
+// New members go in the sorted order crossPop expects
+void DataSet::growPop(unsigned int count)
+{
+    if(count == 0)
+        return;
+
+    unsigned int half = std::max(1u, (unsigned int) population.size() / 2);
+    for(unsigned int i = 0; i < count; i++)
+    {
+        unsigned int source = rng() % half;
+        population.push_back(Tour());
+        Tour& tour = population.back();
+        tour.tour = LinkList(ArenaAllocator<Link>(arena.get()));
+        tour.tour.reserve(cities.size());
+        tour.tour.assign(population[source].tour.begin(), population[source].tour.end());
+
+        // Kick until the edge set is new
+        kick(tour);
+        for(unsigned int attempt = 0; hashCounts.count(tour.hash) && attempt < duplicateRetries; attempt++)
+            kick(tour);
+        addHash(tour.hash);
+    }
+
+    sortPop();
+}
+
+// Population is sorted, weakest last
+void DataSet::shrinkPop(unsigned int count)
+{
+    for(unsigned int i = 0; i < count; i++)
+    {
+        dropHash(population.back().hash);
+        population.pop_back();
+    }
+}
+
+// Mutation counts as accepted if it lowered the cost, the relative drop is
+// the mutator's reward
+void DataSet::countMutation(const Tour& tour, float before, int op)
+{
+    mutateTried++;
+    if(tour.cost < before)
+        mutateAccepted++;
+    if(adaptive)
+        mutateSelector.reward(op - 1, std::max(0.0f, before - tour.cost) / before);
+}
+
+// Hash population
+void DataSet::rehashPop(bool kickDuplicates)
+{
+    if(edgeHash.size() != cities.size())
+        edgeHash = EdgeHash(cities.size());
+
+    hashCounts.clear();
+    for(auto & tour : population)
+    {
+        tour.hash = edgeHash.tour(tour.tour);
+
+        // Seeding often repeats a tour (greedy from different starts)
+        if(kickDuplicates && hashCounts.count(tour.hash))
+            kick(tour);
+
+        addHash(tour.hash);
+    }
+}
+
+// Count hash
+void DataSet::addHash(unsigned long long hash)
+{
+    hashCounts[hash]++;
+}
+
+// Uncount hash, dropping it once no member has it
+void DataSet::dropHash(unsigned long long hash)
+{
+    auto it = hashCounts.find(hash);
+    if(it != hashCounts.end() && --it->second == 0)
+        hashCounts.erase(it);
+}
+
+// Toggle link keys, skipping repeated indices so adjacent picks are not cancelled
+void DataSet::xorLinks(Tour& tour, std::initializer_list<int> links)
+{
+    const int* seen = links.begin();
+    for(const int* i = links.begin(); i != links.end(); i++)
+    {
+        if(std::find(seen, i, *i) != i)
+            continue;
+
+        const Link& link = tour.tour.at(*i);
+        tour.hash ^= edgeHash.key(link.a.num - 1, link.b.num - 1);
+    }
+}
+
+// Random reversal, cost and hash rebuilt
+void DataSet::kick(Tour& tour)
+{
+    kick(tour, rng);
+}
+
+// Kick with the caller's random numbers, safe from parallel tasks
+void DataSet::kick(Tour& tour, std::mt19937& random)
+{
+    std::vector<unsigned int> order;
+    order.reserve(tour.tour.size());
+    for(auto & link : tour.tour)
+        order.push_back(link.a.num - 1);
+
+    // Stretch of 2..n-2 cities, reversing n-1 of them gives the same cycle
+    unsigned int n = order.size();
+    if(n > 3)
+    {
+        unsigned int start = random() % n;
+        unsigned int length = 2 + random() % std::min(n - 3, 50u);
+        if(start + length > n)
+            start = n - length;
+        std::reverse(order.begin() + start, order.begin() + start + length);
+    }
+
+    buildTour(order, tour);
+    tour.hash = edgeHash.tour(tour.tour);
+}
+
 // Crossover population helper
-Tour DataSet::crossover(const Tour& parent1, const Tour& parent2)
+void DataSet::crossover(const Tour& parent1, const Tour& parent2, Tour& child, int op, CrossScratch& scratch, std::mt19937& random)
 {
-    // Child
-    Tour child;
+    // Child slot is recycled, links keep their storage
+    child.tour.clear();
     child.cost = 0;
  
-    if(cross == 1)
+    if(op == 1)
     {
-        City children[cities.size()];
-        bool childSpots[cities.size()] = { false };
+        // Scratch storage instead of stack arrays, large inputs would overflow
+        std::vector<City>& children = scratch.cities;
+        std::vector<char>& childSpots = scratch.spots;
+        children.resize(cities.size());
+        childSpots.assign(cities.size(), false);
         for(unsigned int i = 0; i < cities.size(); i++)
         {
             // Alternate parents, Grab from parent 2 if we can
@@ -621,16 +2445,16 @@ Tour DataSet::crossover(const Tour& parent1, const Tour& parent2)
         child.tour.push_back(Link(child.tour.back().b, child.tour.front().a));
 
         // Calculate cost
-        for(Link link : child.tour)
-            child.cost += link.distance;
+        child.cost = tourCost(child, scratch.order);
         
-        return child;
+        return;
     }
-    else if(cross == 2)
+    else if(op == 2)
     {
-        std::vector<City> citylist;
+        std::vector<City>& citylist = scratch.cities;
+        citylist.clear();
     
-        if((rand() % 2) == 0)
+        if((random() % 2) == 0)
             citylist.push_back(parent1.tour.at(0).a);
         else
             citylist.push_back(parent2.tour.at(0).a);
@@ -679,47 +2503,218 @@ Tour DataSet::crossover(const Tour& parent1, const Tour& parent2)
         child.tour.push_back(Link(child.tour.back().b, child.tour.front().a));
 
         // Update cost
-        for(Link link : child.tour)
-            child.cost += link.distance;
-        
-        // Reset visited status
-        for(unsigned int i = 0; i < cities.size(); i++)
-            cities.at(i).added = false;
+        child.cost = tourCost(child, scratch.order);
+    }
+}
+
+// Snapshot GA state
+void DataSet::saveCheckpoint()
+{
+    GAState state;
+    state.cities = cities.size();
+    state.hash = coordinateHash(xs, ys);
+    state.algorithm = algorithm;
+    state.cross = cross;
+    state.mutate = mutate;
+    state.genCount = genCount;
+    state.mutateCount = mutateCount;
+
+    std::ostringstream engine;
+    engine << rng;
+    state.rng = engine.str();
+
+    for(auto & city : cities)
+        state.cityOrder.push_back(city.num);
+
+    state.tours.reserve(population.size() * cities.size());
+    for(auto & tour : population)
+    {
+        for(auto & link : tour.tour)
+            state.tours.push_back(link.a.num - 1);
+        state.costs.push_back(tour.cost);
+    }
+
+    for(auto & tour : experts)
+    {
+        for(auto & link : tour.tour)
+            state.experts.push_back(link.a.num - 1);
+        state.expertCosts.push_back(tour.cost);
+    }
+
+    if(adaptive)
+    {
+        state.adaptive = true;
+        state.popSize = popSize;
+        state.childCount = childCount;
+        state.basePopSize = basePopSize;
+        state.mutateFactor = mutateFactor;
+        state.baseMutateFactor = baseMutateFactor;
+        state.stallGenerations = stallGenerations;
+        state.stallBest = stallBest;
+        state.popMin = popMin;
+        state.popMax = popMax;
+        state.startPopulation = startPopulation;
+        state.crossSelector = crossSelector.save();
+        state.mutateSelector = mutateSelector.save();
+    }
+
+    checkpointer->post(state);
+    lastCheckpoint = elapsed();
+}
+
+// Restore GA state
+bool DataSet::resumeCheckpoint()
+{
+    if(resumePath.empty() || resumeChecked)
+        return false;
+    resumeChecked = true;
 
-        return child;
+    GAState state;
+    if(!readState(resumePath, state) || state.cities != cities.size() || state.hash != coordinateHash(xs, ys) || state.algorithm != algorithm)
+    {
+        std::cout << "Cannot resume from " << resumePath << ", starting over" << std::endl;
+        return false;
+    }
+
+    unsigned int n = cities.size();
+    cross = state.cross;
+    mutate = state.mutate;
+    genCount = state.genCount;
+    mutateCount = state.mutateCount;
+
+    std::istringstream engine(state.rng);
+    engine >> rng;
+
+    // Cities vector order feeds crossover, put it back as it was
+    std::vector<City> byNum(n);
+    for(auto & city : cities)
+        byNum.at(city.num - 1) = city;
+    for(unsigned int i = 0; i < n; i++)
+        cities.at(i) = byNum.at(state.cityOrder[i] - 1);
+
+    experts.clear();
+    for(unsigned int e = 0; e < state.expertCosts.size(); e++)
+    {
+        experts.push_back(Tour());
+        buildTour(std::vector<unsigned int>(state.experts.begin() + (size_t) e * n, state.experts.begin() + (size_t) (e + 1) * n), experts.back());
+    }
+
+    // A population saved between wisdom experts is empty
+    if(!state.costs.empty())
+    {
+        allocPop(state.costs.size());
+        for(unsigned int i = 0; i < population.size(); i++)
+        {
+            buildTour(std::vector<unsigned int>(state.tours.begin() + (size_t) i * n, state.tours.begin() + (size_t) (i + 1) * n), population.at(i));
+            population.at(i).cost = state.costs[i];
+        }
+        resumePending = true;
+
+        // Adaptation carries on from where it was, a snapshot of a plain run
+        // starts it fresh
+        if(adaptive)
+        {
+            startAdaptive();
+            if(state.adaptive && crossSelector.load(state.crossSelector) && mutateSelector.load(state.mutateSelector))
+            {
+                popSize = state.popSize;
+                childCount = state.childCount;
+                basePopSize = state.basePopSize;
+                mutateFactor = state.mutateFactor;
+                baseMutateFactor = state.baseMutateFactor;
+                stallGenerations = state.stallGenerations;
+                stallBest = state.stallBest;
+                popMin = state.popMin;
+                popMax = state.popMax;
+                startPopulation = state.startPopulation;
+            }
+        }
     }
 
-    return child;
+    std::cout << "Resumed at generation " << genCount << " with " << experts.size() << " experts" << std::endl;
+    return true;
+}
+
+// Population is sorted, best first
+void DataSet::traceGeneration()
+{
+    if((long) genCount == tracedGeneration)
+        return;
+
+    TraceRecord sample = TraceRecord();
+    sample.time = elapsed();
+    sample.run = traceRuns - 1;
+    sample.generation = genCount;
+    sample.best = population.front().cost;
+    sample.worst = population.back().cost;
+
+    double total = 0;
+    for(auto & tour : population)
+        total += tour.cost;
+    sample.mean = total / population.size();
+
+    sample.distinct = hashCounts.size();
+    sample.population = population.size();
+    sample.crossTried = crossTried;
+    sample.crossAccepted = crossAccepted;
+    sample.mutateTried = mutateTried;
+    sample.mutateAccepted = mutateAccepted;
+    tracer->record(sample);
+
+    tracedGeneration = genCount;
+    crossTried = crossAccepted = mutateTried = mutateAccepted = 0;
 }
 
 // Wisdom of crowds
 void DataSet::wisdom()
 {
     // Get time
-    std::srand(std::time(0));
+    rng.seed(std::time(0));
     cheapestTour.time = clock();
 
+    // Matrices live on the heap, n x n overflows a thread's stack past a
+    // thousand or so cities
     unsigned int expertCount = 10;
-    unsigned int adjacency[expertCount][cities.size()] = { 0 };
-    unsigned int frequency[cities.size()][cities.size()] = { 0 };
+    size_t n = cities.size();
+    std::vector<unsigned int> adjacency(expertCount * n, 0);
+    std::vector<unsigned int> frequency(n * n, 0);
     std::vector<unsigned int> max;
-    std::vector<Tour> experts;
+    std::vector<bool> taken(n, false);
+
+    // Finished experts may come back from a checkpoint
+    experts.clear();
+    resumeCheckpoint();
 
-    // Get our experts
-    for(unsigned int i = 0; i < expertCount; i++)
+    // Get our experts, each with an equal share of the budget left
+    for(unsigned int i = experts.size(); i < expertCount; i++)
     {
-        population.clear();
+        if(timeBudget > 0)
+        {
+            double now = elapsed();
+            expertDeadline = now + std::max(0.0, timeBudget - now) / (expertCount - i);
+        }
+
+        if(!resumePending)
+            population.clear();
         genetic();
         experts.push_back(population.at(0));
         std::cout << "E" << std::setw(2) << std::setfill('0') << i + 1 << ": " << population.at(0).cost << std::endl;
         genCount = 0;
+
+        // Next run starts from a fresh population
+        if(checkpointer)
+        {
+            population.clear();
+            saveCheckpoint();
+        }
     }
+    expertDeadline = 0;
     std::cout << std::endl;
 
     // Get adjacency matrix
     for(unsigned int i = 0; i < experts.size(); i++)
         for(unsigned int j = 0; j < cities.size(); j++)
-            adjacency[i][j] = experts.at(i).tour.at(j).a.num;
+            adjacency[i * n + j] = experts.at(i).tour.at(j).a.num;
 
     // Get frequency matrix
     for(unsigned int position = 0; position < cities.size(); position++)
@@ -727,16 +2722,15 @@ void DataSet::wisdom()
         for(unsigned int city = 0; city < cities.size(); city++)
         {
             unsigned int sum = 0;
-            frequency[position][city] = 0;
             for(unsigned int expert = 0; expert < experts.size(); expert++)
             {   
-                if(adjacency[expert][position] == city + 1)
+                if(adjacency[expert * n + position] == city + 1)
                 {
                     sum++;
                 }
             }
 
-            frequency[position][city] = sum;
+            frequency[position * n + city] = sum;
         }
     }
 
@@ -747,9 +2741,9 @@ void DataSet::wisdom()
         unsigned int maximum = 0;
         for(unsigned int j = 0; j < cities.size(); j++)
         {
-            if(std::find(max.begin(), max.end(), j) == max.end() && frequency[i][j] > maximum)
+            if(!taken[j] && frequency[i * n + j] > maximum)
             {
-                maximum = frequency[i][j];
+                maximum = frequency[i * n + j];
                 maxindex = j;
             }
         }
@@ -758,9 +2752,9 @@ void DataSet::wisdom()
         {
             for(unsigned int j = 0; j < cities.size(); j++)
             {
-                if(std::find(max.begin(), max.end(), cities.at(j).num) == max.end())
+                if(!taken[j])
                 {
-                    maxindex = cities.at(j).num;
+                    maxindex = j;
                     break;
                 }
             }
@@ -768,6 +2762,7 @@ void DataSet::wisdom()
     
         std::cout << maxindex << " ";
         max.push_back(maxindex);
+        taken[maxindex] = true;
     }
 
     // Build tour
@@ -0,0 +1,44 @@
+// Jacob Matchuny
+// TSP solver
+// Edge hash source
+
+// Includes from this project
+#include "edgehash.h"
+
+// splitmix64 finalizer
+static unsigned long long mix(unsigned long long z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Constructor
+EdgeHash::EdgeHash(unsigned int n, unsigned long long seed)
+{
+    this->keys.resize(n);
+    for(unsigned int i = 0; i < n; i++)
+        keys[i] = mix(seed + 0x9e3779b97f4a7c15ULL * (i + 1));
+}
+
+// Sum is symmetric, the mix keeps a ^ b ^ ... from cancelling
+unsigned long long EdgeHash::key(unsigned int a, unsigned int b) const
+{
+    return mix(keys[a] + keys[b]);
+}
+
+// XOR over every link
+unsigned long long EdgeHash::tour(const LinkList& links) const
+{
+    unsigned long long hash = 0;
+    for(auto & link : links)
+        hash ^= key(link.a.num - 1, link.b.num - 1);
+
+    return hash;
+}
+
+// City count
+unsigned int EdgeHash::size() const
+{
+    return keys.size();
+}
@@ -0,0 +1,249 @@
+// Jacob Matchuny
+// TSP solver
+// Instance generator source
+
+// Includes from this project
+#include "generator.h"
+#include "tourfile.h"
+
+// Extern includes
+#include <cmath>
+#include <algorithm>
+#include <functional>
+
+// Square side, coordinates run 0 .. SIDE - 1
+static const double SIDE = 1000000;
+
+// Binary magic, the leading byte never starts a text file
+static const char MAGIC[8] = { '\x89', 'T', 'S', 'P', 'B', 'I', 'N', '\n' };
+
+// Cities read per block from a binary file
+static const unsigned int BLOCK = 4096;
+
+// Random - splitmix64 stream with its own uniform and normal draws
+class Random
+{
+    public:
+        // Constructor (seed)
+        Random(unsigned long long seed)
+        {
+            this->state = seed;
+            this->hasSpare = false;
+            this->spare = 0;
+        }
+
+        // Next 64 random bits
+        unsigned long long next()
+        {
+            unsigned long long z = (state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        // Uniform in [0, 1)
+        double uniform()
+        {
+            return (next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        // Standard normal, Box-Muller pairs
+        double normal()
+        {
+            if(hasSpare)
+            {
+                hasSpare = false;
+                return spare;
+            }
+
+            double u = 1 - uniform();
+            double v = uniform();
+            double radius = std::sqrt(-2 * std::log(u));
+            spare = radius * std::sin(2 * M_PI * v);
+            hasSpare = true;
+            return radius * std::cos(2 * M_PI * v);
+        }
+
+    private:
+        unsigned long long state;
+        bool hasSpare;
+        double spare;
+};
+
+// Names accepted
+bool knownDistribution(const std::string& kind)
+{
+    return kind == "uniform" || kind == "clustered" || kind == "grid" || kind == "road";
+}
+
+// Uniform points
+static void uniformCities(unsigned long n, Random& rng, const std::function<void(double, double)>& emit)
+{
+    for(unsigned long i = 0; i < n; i++)
+    {
+        double x = rng.uniform() * SIDE;
+        emit(x, rng.uniform() * SIDE);
+    }
+}
+
+// Blobs of about 100 cities, each center drawn from its own stream so no
+// center table is kept
+static void clusteredCities(unsigned long n, unsigned long long seed, Random& rng, const std::function<void(double, double)>& emit)
+{
+    unsigned long blobs = std::max(1UL, n / 100);
+    double sigma = SIDE / std::sqrt((double) n);
+    for(unsigned long i = 0; i < n; i++)
+    {
+        Random center(seed ^ (0xd1b54a32d192ed03ULL * (rng.next() % blobs + 1)));
+        double cx = center.uniform() * SIDE;
+        double cy = center.uniform() * SIDE;
+        double x = cx + rng.normal() * sigma;
+        emit(x, cy + rng.normal() * sigma);
+    }
+}
+
+// Lattice centered in its cells
+static void gridCities(unsigned long n, const std::function<void(double, double)>& emit)
+{
+    unsigned long columns = (unsigned long) std::ceil(std::sqrt((double) n));
+    double spacing = SIDE / columns;
+    for(unsigned long i = 0; i < n; i++)
+        emit((i % columns + 0.5) * spacing, (i / columns + 0.5) * spacing);
+}
+
+// Roads wander with a slowly turning heading and bounce off the border.
+// Towns are short stretches where the road crawls and cities spread out
+// around it; between them cities sit close to the road.
+static void roadCities(unsigned long n, Random& rng, const std::function<void(double, double)>& emit)
+{
+    unsigned long roads = std::max(1UL, (unsigned long) std::sqrt((double) n) / 10);
+    double step = SIDE * roads / n;
+    for(unsigned long r = 0; r < roads; r++)
+    {
+        double x = rng.uniform() * SIDE;
+        double y = rng.uniform() * SIDE;
+        double heading = rng.uniform() * 2 * M_PI;
+        unsigned long town = 0;
+
+        unsigned long count = n / roads + (r < n % roads ? 1 : 0);
+        for(unsigned long c = 0; c < count; c++)
+        {
+            if(town == 0 && rng.uniform() < 0.01)
+                town = 10 + rng.next() % 90;
+
+            double length = town > 0 ? step * 0.1 : step * (0.5 + rng.uniform());
+            heading += rng.normal() * 0.1;
+            x += std::cos(heading) * length;
+            y += std::sin(heading) * length;
+
+            // Bounce off the border
+            if(x < 0 || x >= SIDE)
+            {
+                x = x < 0 ? -x : 2 * SIDE - x;
+                heading = M_PI - heading;
+            }
+            if(y < 0 || y >= SIDE)
+            {
+                y = y < 0 ? -y : 2 * SIDE - y;
+                heading = -heading;
+            }
+
+            double spread = town > 0 ? step * 3 : step * 0.2;
+            double px = x + rng.normal() * spread;
+            emit(px, y + rng.normal() * spread);
+
+            if(town > 0)
+                town--;
+        }
+    }
+}
+
+// Stream cities straight to the writer
+bool generateInstance(const std::string& path, const std::string& kind, unsigned long n, unsigned long long seed, bool binary)
+{
+    if(!knownDistribution(kind))
+        return false;
+
+    TourWriter out(path);
+    if(binary)
+    {
+        unsigned long long count = n;
+        out.bytes(MAGIC, sizeof(MAGIC));
+        out.bytes(&count, sizeof(count));
+    }
+    else
+    {
+        out.text("NAME: " + kind + std::to_string(n) + "\n");
+        out.text("TYPE: TSP\n");
+        out.text("COMMENT: Generated by tsp-solver (" + kind + ", seed " + std::to_string(seed) + ")\n");
+        out.text("DIMENSION: " + std::to_string(n) + "\n");
+        out.text("EDGE_WEIGHT_TYPE: EUC_2D\n");
+        out.text("NODE_COORD_SECTION\n");
+    }
+
+    // Clamp onto integer coordinates inside the square
+    unsigned long num = 0;
+    auto emit = [&](double x, double y)
+    {
+        long ix = (long) std::min(SIDE - 1, std::max(0.0, std::floor(x)));
+        long iy = (long) std::min(SIDE - 1, std::max(0.0, std::floor(y)));
+        if(binary)
+        {
+            float point[2] = { (float) ix, (float) iy };
+            out.bytes(point, sizeof(point));
+        }
+        else
+        {
+            out.number(++num, ' ');
+            out.number(ix, ' ');
+            out.number(iy, '\n');
+        }
+    };
+
+    Random rng(seed);
+    if(kind == "uniform")
+        uniformCities(n, rng, emit);
+    else if(kind == "clustered")
+        clusteredCities(n, seed, rng, emit);
+    else if(kind == "grid")
+        gridCities(n, emit);
+    else
+        roadCities(n, rng, emit);
+
+    if(!binary)
+        out.text("EOF\n");
+
+    return out.close();
+}
+
+// Magic on the first byte
+bool isBinaryInstance(std::istream& in)
+{
+    return in.peek() == (unsigned char) MAGIC[0];
+}
+
+// Header, then blocks of points
+bool readBinaryInstance(std::istream& in, std::vector<City>& cities)
+{
+    char magic[sizeof(MAGIC)];
+    unsigned long long count;
+    if(!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), MAGIC))
+        return false;
+    if(!in.read((char*) &count, sizeof(count)) || count > 0xffffffffULL)
+        return false;
+
+    cities.clear();
+    cities.reserve(count);
+    std::vector<float> block(2 * BLOCK);
+    while(cities.size() < count)
+    {
+        unsigned int size = (unsigned int) std::min<unsigned long long>(BLOCK, count - cities.size());
+        if(!in.read((char*) block.data(), size * 2 * sizeof(float)))
+            return false;
+
+        for(unsigned int i = 0; i < size; i++)
+            cities.push_back(City(block[2 * i], block[2 * i + 1], cities.size() + 1));
+    }
+
+    return true;
+}
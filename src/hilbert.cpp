@@ -0,0 +1,81 @@
+// Jacob Matchuny
+// TSP solver
+// Hilbert curve source
+
+// Includes from this project
+#include "hilbert.h"
+
+// Extern includes
+#include <algorithm>
+#include <utility>
+
+// Grid resolution for curve keys (2^16 cells a side)
+static const unsigned int hilbertOrderBits = 16;
+
+// Hilbert index of cell
+unsigned long long hilbertIndex(unsigned int x, unsigned int y, unsigned int order)
+{
+    unsigned long long d = 0;
+    unsigned int n = 1u << order;
+
+    for(unsigned int s = n / 2; s > 0; s /= 2)
+    {
+        unsigned int rx = (x & s) > 0;
+        unsigned int ry = (y & s) > 0;
+        d += (unsigned long long) s * s * ((3 * rx) ^ ry);
+
+        // Rotate quadrant
+        if(ry == 0)
+        {
+            if(rx == 1)
+            {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+
+    return d;
+}
+
+// Ids sorted along curve
+std::vector<unsigned int> hilbertOrder(const std::vector<float>& xs, const std::vector<float>& ys, unsigned int variant)
+{
+    unsigned int n = xs.size();
+    std::vector<std::pair<unsigned long long, unsigned int>> keys(n);
+    std::vector<unsigned int> order(n);
+
+    if(n == 0)
+        return order;
+
+    // Bounding box
+    float minX = *std::min_element(xs.begin(), xs.end());
+    float maxX = *std::max_element(xs.begin(), xs.end());
+    float minY = *std::min_element(ys.begin(), ys.end());
+    float maxY = *std::max_element(ys.begin(), ys.end());
+    float span = std::max(std::max(maxX - minX, maxY - minY), 1e-9f);
+    float cells = (float) ((1u << hilbertOrderBits) - 1);
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        unsigned int x = (unsigned int) ((xs[i] - minX) / span * cells);
+        unsigned int y = (unsigned int) ((ys[i] - minY) / span * cells);
+
+        // Mirror and transpose for the curve variant
+        if(variant & 1)
+            x = (unsigned int) cells - x;
+        if(variant & 2)
+            y = (unsigned int) cells - y;
+        if(variant & 4)
+            std::swap(x, y);
+
+        keys[i] = std::make_pair(hilbertIndex(x, y, hilbertOrderBits), i);
+    }
+
+    std::sort(keys.begin(), keys.end());
+    for(unsigned int i = 0; i < n; i++)
+        order[i] = keys[i].second;
+
+    return order;
+}
@@ -0,0 +1,186 @@
+// Jacob Matchuny
+// TSP solver
+// Incremental update source
+
+// Includes from this project
+#include "incremental.h"
+
+// Extern includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Placed cities checked around each new one
+static const unsigned int insertNeighbors = 8;
+
+// Distance between ids
+static inline float dist(const std::vector<float>& xs, const std::vector<float>& ys, unsigned int a, unsigned int b)
+{
+    float dx = xs[a] - xs[b];
+    float dy = ys[a] - ys[b];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Splice out removed cities
+void removeCities(std::vector<unsigned int>& tour, const std::vector<char>& removed, std::vector<unsigned int>& touched)
+{
+    std::vector<unsigned int> kept;
+    kept.reserve(tour.size());
+
+    bool gap = false;
+    for(unsigned int id : tour)
+    {
+        if(removed[id])
+        {
+            // City before the gap
+            if(!gap && !kept.empty())
+                touched.push_back(kept.back());
+            gap = true;
+            continue;
+        }
+
+        // City after the gap
+        if(gap)
+            touched.push_back(id);
+        gap = false;
+        kept.push_back(id);
+    }
+
+    // Gap wrapping past the end touches both ends
+    if(gap && !kept.empty())
+        touched.push_back(kept.front());
+    if(!tour.empty() && removed[tour.front()] && !kept.empty())
+        touched.push_back(kept.back());
+
+    tour.swap(kept);
+}
+
+// Cheapest insertion on a linked tour
+void insertCities(const SpatialGrid& grid, const std::vector<float>& xs, const std::vector<float>& ys, std::vector<unsigned int>& tour, const std::vector<unsigned int>& ids, std::vector<unsigned int>& touched)
+{
+    unsigned int n = xs.size();
+    std::vector<unsigned int> next(n, n), prev(n, n), nearest;
+    std::vector<char> placed(n, false);
+
+    for(unsigned int i = 0; i < tour.size(); i++)
+    {
+        unsigned int a = tour[i];
+        unsigned int b = tour[(i + 1) % tour.size()];
+        next[a] = b;
+        prev[b] = a;
+        placed[a] = true;
+    }
+
+    unsigned int count = tour.size();
+    unsigned int start = tour.empty() ? n : tour.front();
+    for(unsigned int c : ids)
+    {
+        touched.push_back(c);
+
+        // First two cities just make a cycle
+        if(count < 2)
+        {
+            unsigned int other = count == 0 ? c : start;
+            next[c] = prev[c] = other;
+            next[other] = prev[other] = c;
+            placed[c] = true;
+            start = other;
+            count++;
+            continue;
+        }
+
+        // Placed cities near c, or the nearest one when none are in reach
+        grid.kNearest(c, insertNeighbors, nearest);
+        unsigned int found = 0;
+        for(unsigned int id : nearest)
+            if(placed[id])
+                nearest[found++] = id;
+        nearest.resize(found);
+        if(nearest.empty())
+            nearest.push_back(grid.nearest(xs[c], ys[c], [&](unsigned int id) { return placed[id] != 0; }));
+
+        // Edges on both sides of each, cheapest detour wins
+        unsigned int bestA = n;
+        float best = std::numeric_limits<float>::infinity();
+        for(unsigned int p : nearest)
+        {
+            for(unsigned int a : { prev[p], p })
+            {
+                unsigned int b = next[a];
+                float delta = dist(xs, ys, a, c) + dist(xs, ys, c, b) - dist(xs, ys, a, b);
+                if(delta < best)
+                {
+                    best = delta;
+                    bestA = a;
+                }
+            }
+        }
+
+        unsigned int a = bestA, b = next[a];
+        next[a] = c;
+        prev[c] = a;
+        next[c] = b;
+        prev[b] = c;
+        placed[c] = true;
+        touched.push_back(a);
+        touched.push_back(b);
+        count++;
+    }
+
+    // Walk the links back into an order
+    if(count > tour.size())
+    {
+        tour.clear();
+        unsigned int id = start;
+        do
+        {
+            tour.push_back(id);
+            id = next[id];
+        }
+        while(id != start);
+    }
+}
+
+// Candidates around the touched cities
+std::vector<unsigned int> regionCandidates(const SpatialGrid& grid, const std::vector<unsigned int>& touched, unsigned int k)
+{
+    unsigned int n = grid.size();
+    k = std::min(k, n - 1);
+    std::vector<unsigned int> candidates((size_t) n * k, ~0u), nearest;
+    std::vector<char> listed(n, false);
+    if(k == 0)
+        return candidates;
+
+    // Touched cities and their neighbors, so moves can reach one city past the change
+    std::vector<unsigned int> region;
+    for(unsigned int id : touched)
+    {
+        if(listed[id])
+            continue;
+        listed[id] = true;
+        region.push_back(id);
+    }
+    for(unsigned int r = 0, touchedCount = region.size(); r < touchedCount; r++)
+    {
+        grid.kNearest(region[r], k, nearest);
+        std::copy(nearest.begin(), nearest.end(), candidates.begin() + (size_t) region[r] * k);
+        for(unsigned int id : nearest)
+        {
+            if(!listed[id])
+            {
+                listed[id] = true;
+                region.push_back(id);
+            }
+        }
+    }
+
+    for(unsigned int r = 0; r < region.size(); r++)
+    {
+        if(candidates[(size_t) region[r] * k] != ~0u)
+            continue;
+        grid.kNearest(region[r], k, nearest);
+        std::copy(nearest.begin(), nearest.end(), candidates.begin() + (size_t) region[r] * k);
+    }
+
+    return candidates;
+}
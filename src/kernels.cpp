@@ -0,0 +1,295 @@
+// Jacob Matchuny
+// TSP solver
+// Kernels source
+
+// Includes from this project
+#include "kernels.h"
+
+// Extern includes
+#include <cmath>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+// Kernel signatures
+typedef float (*TourLengthFn)(const float*, const float*, const unsigned int*, unsigned int);
+typedef unsigned int (*NearestFn)(const float*, const float*, unsigned int, const unsigned int*, float, float);
+
+// Visited bit for id
+static inline bool isVisited(const unsigned int* visited, unsigned int id)
+{
+    return (visited[id >> 5] >> (id & 31)) & 1;
+}
+
+// 8 visited bits starting at id (id multiple of 8)
+static inline unsigned int visitedByte(const unsigned int* visited, unsigned int id)
+{
+    return (visited[id >> 5] >> (id & 31)) & 0xFF;
+}
+
+// Scalar nearest scan over ids [from, n), continuing from best/bestDist
+static inline void nearestTail(const float* xs, const float* ys, unsigned int from, unsigned int n, const unsigned int* visited, float px, float py, unsigned int& best, float& bestDist)
+{
+    for(unsigned int i = from; i < n; i++)
+    {
+        if(isVisited(visited, i))
+            continue;
+
+        float dx = xs[i] - px;
+        float dy = ys[i] - py;
+        float d = dx * dx + dy * dy;
+        if(d < bestDist)
+        {
+            bestDist = d;
+            best = i;
+        }
+    }
+}
+
+// Lowest distance lane, ties to lowest id
+static inline void laneArgmin(const float* dist, const int* ids, unsigned int lanes, unsigned int& best, float& bestDist)
+{
+    for(unsigned int lane = 0; lane < lanes; lane++)
+    {
+        if(dist[lane] < bestDist || (dist[lane] == bestDist && (unsigned int) ids[lane] < best))
+        {
+            bestDist = dist[lane];
+            best = ids[lane];
+        }
+    }
+}
+
+// Edge perm[i] -> perm[i + 1], closing edge included when i = n - 1
+static inline float edge(const float* xs, const float* ys, const unsigned int* perm, unsigned int n, unsigned int i)
+{
+    unsigned int a = perm[i];
+    unsigned int b = perm[i + 1 == n ? 0 : i + 1];
+    float dx = xs[b] - xs[a];
+    float dy = ys[b] - ys[a];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Plain loop
+__attribute__((unused))
+static float tourLengthScalar(const float* xs, const float* ys, const unsigned int* perm, unsigned int n)
+{
+    float sum = 0;
+    for(unsigned int i = 0; i < n; i++)
+        sum += edge(xs, ys, perm, n, i);
+    return sum;
+}
+
+// Plain nearest scan
+__attribute__((unused))
+static unsigned int nearestScalar(const float* xs, const float* ys, unsigned int n, const unsigned int* visited, float px, float py)
+{
+    unsigned int best = n;
+    float bestDist = INFINITY;
+    nearestTail(xs, ys, 0, n, visited, px, py, best, bestDist);
+    return best;
+}
+
+#ifdef KERNELS_X86
+// 4 edges at a time, SSE has no gather so lanes are loaded one by one
+static float tourLengthSSE(const float* xs, const float* ys, const unsigned int* perm, unsigned int n)
+{
+    __m128 acc = _mm_setzero_ps();
+    unsigned int i = 0;
+
+    // Last full block must not read past perm[n - 1]
+    for(; i + 4 < n; i += 4)
+    {
+        const unsigned int* a = perm + i;
+        const unsigned int* b = perm + i + 1;
+        __m128 dx = _mm_sub_ps(_mm_setr_ps(xs[b[0]], xs[b[1]], xs[b[2]], xs[b[3]]), _mm_setr_ps(xs[a[0]], xs[a[1]], xs[a[2]], xs[a[3]]));
+        __m128 dy = _mm_sub_ps(_mm_setr_ps(ys[b[0]], ys[b[1]], ys[b[2]], ys[b[3]]), _mm_setr_ps(ys[a[0]], ys[a[1]], ys[a[2]], ys[a[3]]));
+        acc = _mm_add_ps(acc, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))));
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    float sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+    // Tail and closing edge
+    for(; i < n; i++)
+        sum += edge(xs, ys, perm, n, i);
+    return sum;
+}
+
+// 8 edges at a time with gathered loads
+__attribute__((target("avx2")))
+static float tourLengthAVX2(const float* xs, const float* ys, const unsigned int* perm, unsigned int n)
+{
+    __m256 acc = _mm256_setzero_ps();
+    unsigned int i = 0;
+
+    for(; i + 8 < n; i += 8)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*) (perm + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*) (perm + i + 1));
+        __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(xs, b, 4), _mm256_i32gather_ps(xs, a, 4));
+        __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(ys, b, 4), _mm256_i32gather_ps(ys, a, 4));
+        acc = _mm256_add_ps(acc, _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy))));
+    }
+
+    // Horizontal sum
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    float sum = _mm_cvtss_f32(half);
+
+    // Tail and closing edge
+    for(; i < n; i++)
+        sum += edge(xs, ys, perm, n, i);
+    return sum;
+}
+
+// 4 candidates at a time
+static unsigned int nearestSSE(const float* xs, const float* ys, unsigned int n, const unsigned int* visited, float px, float py)
+{
+    const __m128 inf = _mm_set1_ps(INFINITY);
+    const __m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+    __m128 x0 = _mm_set1_ps(px), y0 = _mm_set1_ps(py);
+    __m128 bestDist = inf;
+    __m128i bestId = _mm_set1_epi32(n);
+    __m128i ids = _mm_setr_epi32(0, 1, 2, 3);
+    unsigned int i = 0;
+
+    for(; i + 4 <= n; i += 4, ids = _mm_add_epi32(ids, _mm_set1_epi32(4)))
+    {
+        unsigned int nibble = (visited[i >> 5] >> (i & 31)) & 0xF;
+        if(nibble == 0xF)
+            continue;
+
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), x0);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), y0);
+        __m128 d = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+        // Visited lanes never win
+        __m128i taken = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(nibble), bits), bits);
+        d = _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(taken), inf), _mm_andnot_ps(_mm_castsi128_ps(taken), d));
+
+        // Strictly closer keeps first id per lane
+        __m128 closer = _mm_cmplt_ps(d, bestDist);
+        bestDist = _mm_or_ps(_mm_and_ps(closer, d), _mm_andnot_ps(closer, bestDist));
+        bestId = _mm_or_si128(_mm_and_si128(_mm_castps_si128(closer), ids), _mm_andnot_si128(_mm_castps_si128(closer), bestId));
+    }
+
+    // Horizontal argmin
+    float dist[4];
+    int lanes[4];
+    unsigned int best = n;
+    float min = INFINITY;
+    _mm_storeu_ps(dist, bestDist);
+    _mm_storeu_si128((__m128i*) lanes, bestId);
+    laneArgmin(dist, lanes, 4, best, min);
+
+    nearestTail(xs, ys, i, n, visited, px, py, best, min);
+    return best;
+}
+
+// 8 candidates at a time
+__attribute__((target("avx2")))
+static unsigned int nearestAVX2(const float* xs, const float* ys, unsigned int n, const unsigned int* visited, float px, float py)
+{
+    const __m256 inf = _mm256_set1_ps(INFINITY);
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    __m256 x0 = _mm256_set1_ps(px), y0 = _mm256_set1_ps(py);
+    __m256 bestDist = inf;
+    __m256i bestId = _mm256_set1_epi32(n);
+    __m256i ids = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    unsigned int i = 0;
+
+    for(; i + 8 <= n; i += 8, ids = _mm256_add_epi32(ids, _mm256_set1_epi32(8)))
+    {
+        // Whole block already visited
+        unsigned int byte = visitedByte(visited, i);
+        if(byte == 0xFF)
+            continue;
+
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), x0);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), y0);
+        __m256 d = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+        // Visited lanes never win
+        __m256i taken = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(byte), bits), bits);
+        d = _mm256_blendv_ps(d, inf, _mm256_castsi256_ps(taken));
+
+        // Strictly closer keeps first id per lane
+        __m256 closer = _mm256_cmp_ps(d, bestDist, _CMP_LT_OQ);
+        bestDist = _mm256_blendv_ps(bestDist, d, closer);
+        bestId = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestId), _mm256_castsi256_ps(ids), closer));
+    }
+
+    // Horizontal argmin
+    float dist[8];
+    int lanes[8];
+    unsigned int best = n;
+    float min = INFINITY;
+    _mm256_storeu_ps(dist, bestDist);
+    _mm256_storeu_si256((__m256i*) lanes, bestId);
+    laneArgmin(dist, lanes, 8, best, min);
+
+    nearestTail(xs, ys, i, n, visited, px, py, best, min);
+    return best;
+}
+#endif
+
+// Kernel set for one instruction set
+struct KernelSet
+{
+    TourLengthFn length;
+    NearestFn nearest;
+    const char* name;
+};
+
+// Pick best kernels for this cpu
+static KernelSet selectKernels()
+{
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+        return { tourLengthAVX2, nearestAVX2, "avx2" };
+    return { tourLengthSSE, nearestSSE, "sse" };
+#else
+    return { tourLengthScalar, nearestScalar, "scalar" };
+#endif
+}
+
+// Selected kernels, picked on first use
+static const KernelSet& selected()
+{
+    static const KernelSet kernels = selectKernels();
+    return kernels;
+}
+
+// Closed tour length
+float tourLength(const float* xs, const float* ys, const unsigned int* perm, unsigned int n)
+{
+    if(n < 2)
+        return 0;
+    return selected().length(xs, ys, perm, n);
+}
+
+// Batch of closed tour lengths
+void tourLengthBatch(const float* xs, const float* ys, const unsigned int* perms, unsigned int n, unsigned int count, float* out)
+{
+    TourLengthFn kernel = selected().length;
+    for(unsigned int i = 0; i < count; i++)
+        out[i] = n < 2 ? 0 : kernel(xs, ys, perms + (size_t) i * n, n);
+}
+
+// Closest unvisited id
+unsigned int nearestUnvisited(const float* xs, const float* ys, unsigned int n, const unsigned int* visited, float px, float py)
+{
+    return selected().nearest(xs, ys, n, visited, px, py);
+}
+
+// Instruction set in use
+const char* kernelName()
+{
+    return selected().name;
+}
@@ -0,0 +1,210 @@
+// Jacob Matchuny
+// TSP solver
+// Local search source
+
+// Includes from this project
+#include "localsearch.h"
+
+// Extern includes
+#include <cmath>
+
+// Smallest gain worth a move
+static const double EPSILON = 1e-6;
+
+// Constructor
+LocalSearch::LocalSearch(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<unsigned int>& candidates, unsigned int k) : xs(xs), ys(ys), candidates(candidates)
+{
+    this->k = k;
+    this->n = xs.size();
+    this->maxMoves = 0;
+    this->useOrOpt = true;
+    this->moves = 0;
+}
+
+// Distance between ids
+double LocalSearch::dist(unsigned int a, unsigned int b) const
+{
+    double dx = xs[a] - xs[b];
+    double dy = ys[a] - ys[b];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Queue city once
+void LocalSearch::push(unsigned int id)
+{
+    if(!queued[id])
+    {
+        queued[id] = true;
+        queue.push_back(id);
+    }
+}
+
+// Whole tour active
+double LocalSearch::optimize(std::vector<unsigned int>& order)
+{
+    return optimize(order, order);
+}
+
+// Pick the tour structure by size
+double LocalSearch::optimize(std::vector<unsigned int>& order, const std::vector<unsigned int>& active)
+{
+    n = order.size();
+    moves = 0;
+    if(n < 5 || k == 0)
+        return 0;
+
+    queued.assign(n, false);
+    queue.clear();
+    for(unsigned int id : active)
+        push(id);
+
+    double gain;
+    if(n >= twoLevelLimit)
+    {
+        TwoLevelTour tour(order);
+        gain = search(tour);
+        order = tour.sequence();
+    }
+    else
+    {
+        ArrayTour tour(order);
+        gain = search(tour);
+        order = tour.sequence();
+    }
+
+    return gain;
+}
+
+// Run until the queue drains or the move cap is hit
+template<class TourType>
+double LocalSearch::search(TourType& tour)
+{
+    double gain = 0;
+    while(!queue.empty() && (maxMoves == 0 || moves < maxMoves))
+    {
+        unsigned int a = queue.front();
+        queue.pop_front();
+        queued[a] = false;
+
+        // Moves requeue their endpoints, a included
+        if(improveTwoOpt(tour, a, gain) || (useOrOpt && improveOrOpt(tour, a, gain)))
+            moves++;
+    }
+
+    return gain;
+}
+
+// Orientation independent 2-opt
+template<class TourType>
+void LocalSearch::exchange(TourType& tour, unsigned int a, unsigned int b, unsigned int c, unsigned int d)
+{
+    if(tour.next(a) == b)
+        tour.flip(a, b, c, d);
+    else
+        tour.flip(b, a, d, c);
+}
+
+// 2-opt with a's successor or predecessor, candidates closest first
+template<class TourType>
+bool LocalSearch::improveTwoOpt(TourType& tour, unsigned int a, double& gain)
+{
+    for(int side = 0; side < 2; side++)
+    {
+        unsigned int b = side == 0 ? tour.next(a) : tour.prev(a);
+        double ab = dist(a, b);
+
+        for(unsigned int i = 0; i < k; i++)
+        {
+            unsigned int c = candidates[(size_t) a * k + i];
+            if(c >= n)
+                break;
+
+            // New edge must be shorter than the one it replaces
+            double g1 = ab - dist(a, c);
+            if(g1 <= EPSILON)
+                break;
+
+            unsigned int d = side == 0 ? tour.next(c) : tour.prev(c);
+            if(c == b || d == a)
+                continue;
+
+            double delta = g1 + dist(c, d) - dist(b, d);
+            if(delta > EPSILON)
+            {
+                exchange(tour, a, b, c, d);
+                push(a);
+                push(b);
+                push(c);
+                push(d);
+                gain += delta;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Move the 1-3 city segment starting at a between a candidate and its neighbor
+template<class TourType>
+bool LocalSearch::improveOrOpt(TourType& tour, unsigned int a, double& gain)
+{
+    unsigned int last = a;
+    for(unsigned int length = 1; length <= 3 && length + 2 < n; length++)
+    {
+        if(length > 1)
+            last = tour.next(last);
+
+        unsigned int prev = tour.prev(a);
+        unsigned int next = tour.next(last);
+        double removed = dist(prev, a) + dist(last, next) - dist(prev, next);
+        if(removed <= EPSILON)
+            continue;
+
+        for(unsigned int i = 0; i < k; i++)
+        {
+            unsigned int c = candidates[(size_t) a * k + i];
+            if(c >= n || dist(a, c) >= removed)
+                break;
+            if(tour.between(a, c, last))
+                continue;
+
+            // Edge after c, then edge before c
+            for(int side = 0; side < 2; side++)
+            {
+                unsigned int x = side == 0 ? c : tour.prev(c);
+                unsigned int y = tour.next(x);
+                if(x == next || y == prev || tour.between(a, x, last) || tour.between(a, y, last))
+                    continue;
+
+                double forward = dist(x, a) + dist(last, y);
+                double reversed = dist(x, last) + dist(a, y);
+                double delta = removed + dist(x, y) - std::min(forward, reversed);
+                if(delta <= EPSILON)
+                    continue;
+
+                // Three 2-opt moves: cut the segment out reversed between x and y,
+                // close the gap, then turn the segment around if that is shorter
+                exchange(tour, prev, a, x, y);
+                exchange(tour, prev, x, next, last);
+                if(forward < reversed)
+                    exchange(tour, x, last, a, y);
+
+                push(prev);
+                push(next);
+                push(a);
+                push(last);
+                push(x);
+                push(y);
+                gain += delta;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Both tour structures
+template double LocalSearch::search<ArrayTour>(ArrayTour&);
+template double LocalSearch::search<TwoLevelTour>(TwoLevelTour&);
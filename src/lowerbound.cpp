@@ -0,0 +1,380 @@
+// Jacob Matchuny
+// TSP solver
+// Lower bound source
+
+// Includes from this project
+#include "lowerbound.h"
+#include "spatialgrid.h"
+#include "construct.h"
+#include "kernels.h"
+
+// Extern includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+// Constructor
+LowerBound::LowerBound(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<unsigned int>& candidates, unsigned int k)
+{
+    unsigned int n = xs.size();
+    this->xs = xs;
+    this->ys = ys;
+    this->pi.assign(n, 0);
+    this->degree.assign(n, 0);
+    this->best = 0;
+    this->halt = false;
+    this->done = 0;
+    this->dense = n <= denseLimit;
+    this->candidates = candidates;
+    this->candidateK = k;
+
+    // Dense runs are cheap per city, sparse ones scale the cap with the graph
+    if(dense)
+        this->maxIterations = 1000;
+    else
+        this->maxIterations = std::min(1000.0, std::max(30.0, 2e8 / ((double) n * std::max(k, 1u))));
+
+    if(dense || n < 3)
+        return;
+
+    // Symmetric candidate graph (CSR)
+    std::vector<std::pair<unsigned int, unsigned int>> edges;
+    for(unsigned int i = 0; i < n; i++)
+    {
+        for(unsigned int c = 0; c < k; c++)
+        {
+            unsigned int j = candidates[(size_t) i * k + c];
+            if(j < n && j != i)
+            {
+                edges.push_back(std::make_pair(i, j));
+                edges.push_back(std::make_pair(j, i));
+            }
+        }
+    }
+
+    // Link stray components (city 0 sits outside the tree) to their nearest outsider
+    std::vector<unsigned int> component(n, n);
+    std::vector<std::vector<unsigned int>> adjacency(n);
+    for(auto & e : edges)
+        adjacency[e.first].push_back(e.second);
+
+    SpatialGrid grid(this->xs, this->ys);
+    unsigned int components = 0;
+    for(unsigned int root = 1; root < n; root++)
+    {
+        if(component[root] != n)
+            continue;
+
+        // Flood fill
+        std::vector<unsigned int> stack(1, root);
+        component[root] = components;
+        while(!stack.empty())
+        {
+            unsigned int v = stack.back();
+            stack.pop_back();
+            for(unsigned int w : adjacency[v])
+            {
+                if(w != 0 && component[w] == n)
+                {
+                    component[w] = components;
+                    stack.push_back(w);
+                }
+            }
+        }
+
+        if(components > 0)
+        {
+            unsigned int other = grid.nearest(this->xs[root], this->ys[root], [&](unsigned int id) { return id != 0 && component[id] != n && component[id] != component[root]; });
+            if(other < n)
+            {
+                edges.push_back(std::make_pair(root, other));
+                edges.push_back(std::make_pair(other, root));
+            }
+        }
+        components++;
+    }
+
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    neighborStart.assign(n + 1, 0);
+    for(auto & e : edges)
+        neighborStart[e.first + 1]++;
+    for(unsigned int i = 0; i < n; i++)
+        neighborStart[i + 1] += neighborStart[i];
+
+    neighbors.resize(edges.size());
+    for(unsigned int i = 0; i < edges.size(); i++)
+        neighbors[i] = edges[i].second;
+}
+
+// Destructor
+LowerBound::~LowerBound()
+{
+    stop();
+    wait();
+}
+
+// Background run
+void LowerBound::start()
+{
+    if(!worker.joinable())
+        worker = std::thread(&LowerBound::run, this);
+}
+
+// Finish early
+void LowerBound::stop()
+{
+    halt = true;
+}
+
+// Wait for background run
+void LowerBound::wait()
+{
+    if(worker.joinable())
+        worker.join();
+}
+
+// Best bound
+float LowerBound::bound() const
+{
+    return best;
+}
+
+// Complete graph used
+bool LowerBound::exact() const
+{
+    return dense;
+}
+
+// Iterations done
+unsigned int LowerBound::iterations() const
+{
+    return done;
+}
+
+// Penalized distance
+double LowerBound::weight(unsigned int a, unsigned int b) const
+{
+    double dx = xs[a] - xs[b];
+    double dy = ys[a] - ys[b];
+    return std::sqrt(dx * dx + dy * dy) + pi[a] + pi[b];
+}
+
+// Minimum 1-tree
+double LowerBound::oneTree()
+{
+    std::fill(degree.begin(), degree.end(), 0);
+    return dense ? oneTreeDense() : oneTreeSparse();
+}
+
+// O(n^2) Prim over cities 1..n-1, then city 0's two cheapest edges
+double LowerBound::oneTreeDense()
+{
+    unsigned int n = xs.size();
+    std::vector<double> key(n, std::numeric_limits<double>::infinity());
+    std::vector<unsigned int> parent(n, 0);
+    std::vector<char> inTree(n, false);
+    double total = 0;
+
+    key[1] = 0;
+    for(unsigned int step = 1; step < n; step++)
+    {
+        unsigned int v = 0;
+        double min = std::numeric_limits<double>::infinity();
+        for(unsigned int i = 1; i < n; i++)
+        {
+            if(!inTree[i] && key[i] < min)
+            {
+                min = key[i];
+                v = i;
+            }
+        }
+
+        inTree[v] = true;
+        if(step > 1)
+        {
+            total += min;
+            degree[v]++;
+            degree[parent[v]]++;
+        }
+
+        for(unsigned int i = 1; i < n; i++)
+        {
+            if(!inTree[i])
+            {
+                double w = weight(v, i);
+                if(w < key[i])
+                {
+                    key[i] = w;
+                    parent[i] = v;
+                }
+            }
+        }
+    }
+
+    // Two cheapest edges at city 0
+    double first = std::numeric_limits<double>::infinity(), second = first;
+    unsigned int a = 1, b = 1;
+    for(unsigned int i = 1; i < n; i++)
+    {
+        double w = weight(0, i);
+        if(w < first)
+        {
+            second = first;
+            b = a;
+            first = w;
+            a = i;
+        }
+        else if(w < second)
+        {
+            second = w;
+            b = i;
+        }
+    }
+
+    degree[0] = 2;
+    degree[a]++;
+    degree[b]++;
+    return total + first + second;
+}
+
+// Heap Prim over the candidate graph
+double LowerBound::oneTreeSparse()
+{
+    unsigned int n = xs.size();
+    std::vector<double> key(n, std::numeric_limits<double>::infinity());
+    std::vector<unsigned int> parent(n, 0);
+    std::vector<char> inTree(n, false);
+    std::priority_queue<std::pair<double, unsigned int>, std::vector<std::pair<double, unsigned int>>, std::greater<std::pair<double, unsigned int>>> heap;
+    double total = 0;
+
+    key[1] = 0;
+    parent[1] = 1;
+    heap.push(std::make_pair(0.0, 1u));
+    while(!heap.empty())
+    {
+        unsigned int v = heap.top().second;
+        double w = heap.top().first;
+        heap.pop();
+        if(inTree[v] || w > key[v])
+            continue;
+
+        inTree[v] = true;
+        if(parent[v] != v)
+        {
+            total += w;
+            degree[v]++;
+            degree[parent[v]]++;
+        }
+
+        for(unsigned int e = neighborStart[v]; e < neighborStart[v + 1]; e++)
+        {
+            unsigned int u = neighbors[e];
+            if(u == 0 || inTree[u])
+                continue;
+
+            double uw = weight(v, u);
+            if(uw < key[u])
+            {
+                key[u] = uw;
+                parent[u] = v;
+                heap.push(std::make_pair(uw, u));
+            }
+        }
+    }
+
+    // Two cheapest candidate edges at city 0
+    double first = std::numeric_limits<double>::infinity(), second = first;
+    unsigned int a = 1, b = 1;
+    for(unsigned int e = neighborStart[0]; e < neighborStart[1]; e++)
+    {
+        unsigned int i = neighbors[e];
+        double w = weight(0, i);
+        if(w < first)
+        {
+            second = first;
+            b = a;
+            first = w;
+            a = i;
+        }
+        else if(w < second)
+        {
+            second = w;
+            b = i;
+        }
+    }
+
+    degree[0] = 2;
+    degree[a]++;
+    degree[b]++;
+    return total + first + second;
+}
+
+// Subgradient optimization
+void LowerBound::run()
+{
+    unsigned int n = xs.size();
+    if(n < 3)
+        return;
+
+    // Upper bound for step sizes from a greedy edge tour
+    std::vector<unsigned int> tour = greedyEdgeTour(xs, ys, candidates, candidateK);
+    double upper = tourLength(xs.data(), ys.data(), tour.data(), n);
+
+    // Ascent as in LKH: step doubles while it pays off, then halves every
+    // period, and each move mixes in the previous subgradient
+    double step = 0.01 * upper / n;
+    double bestW = -std::numeric_limits<double>::infinity();
+    unsigned int period = std::max(std::min(n / 2, maxIterations / 4), 10u), count = 0;
+    bool initial = true;
+    std::vector<int> lastDegree(n, 0);
+
+    for(unsigned int it = 0; it < maxIterations && !halt; it++)
+    {
+        double sumPi = 0;
+        for(unsigned int i = 0; i < n; i++)
+            sumPi += pi[i];
+
+        double w = oneTree() - 2 * sumPi;
+        done = it + 1;
+
+        // All degrees 2 means the 1-tree is a tour
+        double norm = 0;
+        for(unsigned int i = 0; i < n; i++)
+            norm += (double) (degree[i] - 2) * (degree[i] - 2);
+
+        if(w > bestW + 1e-9)
+        {
+            bestW = w;
+            best = (float) w;
+            if(initial && it > 0)
+                step *= 2;
+            if(count == period - 1)
+                period *= 2;
+        }
+        else if(initial && count > period / 2)
+        {
+            initial = false;
+            count = 0;
+            step = 3 * step / 4;
+        }
+
+        if(norm == 0 || period == 0 || step < 1e-6 * upper / n)
+            break;
+
+        for(unsigned int i = 0; i < n; i++)
+        {
+            pi[i] += step * (7 * (degree[i] - 2) + 3 * lastDegree[i]) / 10;
+            lastDegree[i] = degree[i] - 2;
+        }
+
+        if(++count >= period)
+        {
+            step /= 2;
+            period /= 2;
+            count = 0;
+        }
+    }
+}
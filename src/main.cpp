@@ -1,10 +1,15 @@
 // Extern includes
 #include <iostream>
+#include <map>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
 
 // Includes from project
 #include "city.h"
 #include "link.h"
 #include "dataset.h"
+#include "server.h"
 
 // Global dataset
 DataSet ds;
@@ -14,6 +19,10 @@ using namespace std;
 // Command line functions
 void help();
 void parseArgs(int, char**);
+void applyOptions();
+
+// Options given as --name or --name=value
+map<string, string> options;
 
 // Main function
 int main(int argc, char** argv)
@@ -22,14 +31,15 @@ int main(int argc, char** argv)
     FILE* file = freopen("/dev/null", "w", stderr);
     fclose(file);
 
-    // Parse command line args
+    // Parse command line args, starts the solver thread
     parseArgs(argc, argv);
 
-    // Display resulting cheapest tour
-    ds.printResults();
+    // Print graph, redrawn as the solver improves the tour
+    if(!options.count("headless"))
+        ds.printGraph();
 
-    // Print graph
-    ds.printGraph();
+    // Solver prints results when it finishes
+    ds.waitSolve();
 
     return 0;
 }
@@ -41,20 +51,114 @@ void help()
     std::cout << "----------------------- HELP -----------------------" << std::endl;
     std::cout << " ./tsp-solver <filename> <algorithm> <args> " << std::endl << std::endl;
     std::cout << "<filename>  : must be concorde format .tsp file" << std::endl << std::endl;
-    std::cout << "<algorithm> : must be [ brute, greedy, genetic ]" << std::endl << std::endl;
+    std::cout << "<algorithm> : must be [ brute, greedy, sfc, construct, anneal, aco, tabu, partition, update, genetic, wisdom ]" << std::endl << std::endl;
     std::cout << "<args>      : brute   : NONE" << std::endl;
     std::cout << "            : greedy  : NONE" << std::endl;
+    std::cout << "            : sfc     : NONE" << std::endl;
+    std::cout << "            : construct : [ greedy-edge, savings, christofides ]" << std::endl;
+    std::cout << "            : anneal  : NONE" << std::endl;
+    std::cout << "            : aco     : NONE" << std::endl;
+    std::cout << "            : tabu    : NONE" << std::endl;
+    std::cout << "            : partition : <algorithm> <args> (run on each cluster)" << std::endl;
+    std::cout << "            : update  : <tour file> <delta file> (\"+ num x y\" / \"- num\" lines)" << std::endl;
     std::cout << "            : genetic : <crossover> <mutator> " << std::endl;
-    std::cout << "            : wisdom  : <crossover> <mutator> " << std::endl;
+    std::cout << "            : wisdom  : <crossover> <mutator> " << std::endl << std::endl;
+    std::cout << " ./tsp-solver serve <socket> <cache size> " << std::endl;
+    std::cout << " ./tsp-solver client <socket> <filename> <algorithm> <budget ms> <args> " << std::endl;
+    std::cout << " ./tsp-solver generate <distribution> <cities> <filename> <seed> " << std::endl;
+    std::cout << "<distribution> : [ uniform, clustered, grid, road ] (--binary for the binary format)" << std::endl;
+    std::cout << " ./tsp-solver summarize <target cost> <trace files> (0 = cheapest traced cost)" << std::endl << std::endl;
+    std::cout << "<options>   : --stats      : print allocation and timing statistics" << std::endl;
+    std::cout << "            : --headless   : solve without opening the window" << std::endl;
+    std::cout << "            : --hilbert    : renumber cities along a Hilbert curve" << std::endl;
+    std::cout << "            : --init=<how> : GA seeding [ greedy, sfc, greedy-edge, savings, christofides ]" << std::endl;
+    std::cout << "            : --bound      : report Held-Karp lower bound and gap" << std::endl;
+    std::cout << "            : --gap=<pct>  : stop iterative solvers within pct of the bound" << std::endl;
+    std::cout << "            : --time=<ms>  : wall time budget for iterative solvers" << std::endl;
+    std::cout << "            : --threads=<n> : solver threads (default one per core)" << std::endl;
+    std::cout << "            : --pin        : pin solver threads to cores" << std::endl;
+    std::cout << "            : --replicas=<n> : anneal replicas" << std::endl;
+    std::cout << "            : --temp=<t>   : anneal start temperature in mean edges" << std::endl;
+    std::cout << "            : --cooling=<c> : anneal cooling per sweep" << std::endl;
+    std::cout << "            : --ants=<n>   : aco ants per iteration" << std::endl;
+    std::cout << "            : --tenure=<n> : tabu steps an edge stays forbidden (drawn from n .. 2n - 1)" << std::endl;
+    std::cout << "            : --cluster=<n> : partition cities per cluster" << std::endl;
+    std::cout << "            : --polish     : partition local search across cluster borders" << std::endl;
+    std::cout << "            : --memetic[=<moves>] : GA local search on each child (move budget)" << std::endl;
+    std::cout << "            : --adaptive   : GA picks operators, mutation rate and population size itself" << std::endl;
+    std::cout << "            : --batch[=<n>] : GA breeds n children per generation in parallel (default half the population)" << std::endl;
+    std::cout << "            : --warm=<file> : start from a .tour file" << std::endl;
+    std::cout << "            : --out=<file> : write the cheapest tour as a .tour file" << std::endl;
+    std::cout << "            : --checkpoint=<file> : snapshot GA / wisdom state to file" << std::endl;
+    std::cout << "            : --every=<ms> : time between snapshots" << std::endl;
+    std::cout << "            : --resume[=<file>] : continue from a snapshot" << std::endl;
+    std::cout << "            : --trace=<file> : GA / wisdom convergence trace (.csv text, else binary)" << std::endl;
+    std::cout << "            : --trace-every=<k> : generations between trace samples" << std::endl;
     std::cout << "-----------------------------------------------------" << std::endl;
 }
 
 // Parse command line args
 void parseArgs(int argc, char** argv)
 {
+    // Pull out options, keep positional args in order
+    int count = 1;
+    for(int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if(arg.compare(0, 2, "--") == 0)
+        {
+            size_t eq = arg.find('=');
+            options[arg.substr(2, eq == string::npos ? string::npos : eq - 2)] = eq == string::npos ? "" : arg.substr(eq + 1);
+        }
+        else
+            argv[count++] = argv[i];
+    }
+    argc = count;
+
     // Parse args
     int rc = 1;
-    if(argc > 2)
+    if(argc > 2 && std::string(argv[1]).compare("serve") == 0)
+    {
+        // Long lived solver, never returns
+        Server server(argv[2], argc > 3 ? atoi(argv[3]) : 64);
+        server.run();
+        exit(1);
+    }
+    else if(argc > 4 && std::string(argv[1]).compare("client") == 0)
+    {
+        double budget = argc > 5 ? atof(argv[5]) : 0;
+        int cross = argc > 6 ? atoi(argv[6]) : 1;
+        int mutate = argc > 7 ? atoi(argv[7]) : 1;
+        exit(runClient(argv[2], argv[3], argv[4], budget, cross, mutate));
+    }
+    else if(argc > 4 && std::string(argv[1]).compare("generate") == 0)
+    {
+        if(!knownDistribution(argv[2]))
+        {
+            help();
+            exit(1);
+        }
+
+        // Streams the instance out, nothing to solve or draw
+        unsigned long n = strtoul(argv[3], NULL, 10);
+        unsigned long long seed = argc > 5 ? strtoull(argv[5], NULL, 10) : 1;
+        auto start = std::chrono::steady_clock::now();
+        if(!generateInstance(argv[4], argv[2], n, seed, options.count("binary") > 0))
+        {
+            std::cout << "Could not write: " << argv[4] << std::endl;
+            exit(1);
+        }
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Generated " << n << " " << argv[2] << " cities (seed " << seed << ") in " << ms << " ms: " << argv[4] << std::endl;
+        exit(0);
+    }
+    else if(argc > 3 && std::string(argv[1]).compare("summarize") == 0)
+    {
+        // Each file is one setting, ranked by time to target
+        exit(summarizeTraces(std::vector<std::string>(argv + 3, argv + argc), atof(argv[2])));
+    }
+    else if(argc > 2)
     {    
         // Create new dataset
         ds = DataSet(argv[1]);
@@ -64,38 +168,61 @@ void parseArgs(int argc, char** argv)
 
         // Read in cities from file
         ds.readInData();
+        applyOptions();
 
-        // Determine Algorithm
-        if(ds.algorithm.compare("brute") == 0)
+        // Construction needs its heuristic
+        if(ds.algorithm.compare("construct") == 0)
         {
-            ds.brute();
-            rc = 0;
+            if(argc > 3)
+            {
+                ds.constructMethod = argv[3];
+                rc = !ds.solveLive();
+            }
         }
-        else if(ds.algorithm.compare("greedy") == 0)
+        // Partition takes the per cluster algorithm and its args
+        else if(ds.algorithm.compare("partition") == 0)
         {
-            ds.greedy();
-            rc = 0;
+            if(argc > 3)
+            {
+                ds.partAlgorithm = argv[3];
+                if(ds.partAlgorithm.compare("construct") == 0 && argc > 4)
+                    ds.constructMethod = argv[4];
+                else if(argc > 5)
+                {
+                    ds.cross = atoi(argv[4]);
+                    ds.mutate = atoi(argv[5]);
+                }
+                rc = !ds.solveLive();
+            }
         }
-        else if(ds.algorithm.compare("genetic") == 0)
+        // Update needs the previous tour and the delta
+        else if(ds.algorithm.compare("update") == 0)
         {
             if(argc > 4)
             {
-                ds.cross = atoi(argv[3]);
-                ds.mutate = atoi(argv[4]);
-                ds.genetic();
-                rc = 0;
+                ds.tourPath = argv[3];
+                ds.deltaPath = argv[4];
+
+                // New coordinates go in before the window can draw them
+                ds.applyDelta();
+                rc = !ds.solveLive();
             }
         }
-        else if(ds.algorithm.compare("wisdom") == 0)
+        // Genetic algorithms need crossover and mutator
+        else if(ds.algorithm.compare("genetic") == 0 || ds.algorithm.compare("wisdom") == 0)
         {
             if(argc > 4)
             {
                 ds.cross = atoi(argv[3]);
                 ds.mutate = atoi(argv[4]);
-                ds.wisdom();
-                rc = 0;
+                rc = !ds.solveLive();
             }
         }
+        // Determine Algorithm
+        else
+        {
+            rc = !ds.solveLive();
+        }
     }
     
     if(rc)
@@ -104,3 +231,68 @@ void parseArgs(int argc, char** argv)
         exit(0);
     }
 }
+
+// Apply options to dataset
+void applyOptions()
+{
+    // Pool is built on first use, so before any solver runs
+    if(options.count("threads") || options.count("pin"))
+        ThreadPool::configure(atoi(options["threads"].c_str()), options.count("pin") > 0);
+    if(options.count("stats"))
+        ds.showStats = true;
+    if(options.count("hilbert"))
+        ds.hilbertReorder();
+    if(options.count("init"))
+        ds.initMethod = options["init"];
+    if(options.count("bound"))
+        ds.computeBound = true;
+    if(options.count("gap"))
+        ds.targetGap = atof(options["gap"].c_str());
+    if(options.count("time"))
+        ds.timeBudget = atof(options["time"].c_str());
+    if(options.count("replicas"))
+        ds.annealReplicas = atoi(options["replicas"].c_str());
+    if(options.count("temp"))
+        ds.annealTemp = atof(options["temp"].c_str());
+    if(options.count("cooling"))
+        ds.annealCooling = atof(options["cooling"].c_str());
+    if(options.count("ants") && atoi(options["ants"].c_str()) > 0)
+        ds.antCount = atoi(options["ants"].c_str());
+    if(options.count("tenure") && atoi(options["tenure"].c_str()) > 0)
+        ds.tabuTenure = atoi(options["tenure"].c_str());
+    if(options.count("cluster"))
+        ds.clusterSize = atoi(options["cluster"].c_str());
+    if(options.count("polish"))
+        ds.polish = true;
+    if(options.count("memetic"))
+    {
+        ds.memetic = true;
+        if(!options["memetic"].empty())
+            ds.memeticMoves = atol(options["memetic"].c_str());
+    }
+    if(options.count("warm"))
+        ds.loadWarmStart(options["warm"]);
+    if(options.count("out"))
+        ds.tourOut = options["out"];
+    if(options.count("adaptive"))
+        ds.adaptive = true;
+    if(options.count("batch"))
+    {
+        ds.batch = true;
+        ds.batchSize = atoi(options["batch"].c_str());
+    }
+    if(options.count("trace"))
+        ds.tracePath = options["trace"];
+    if(options.count("trace-every"))
+        ds.traceEvery = std::max(1, atoi(options["trace-every"].c_str()));
+    if(options.count("checkpoint"))
+        ds.checkpointPath = options["checkpoint"];
+    if(options.count("every"))
+        ds.checkpointInterval = atof(options["every"].c_str());
+
+    // Resume from the checkpoint file unless given one, and keep saving there
+    if(options.count("resume"))
+        ds.resumePath = options["resume"].empty() ? ds.checkpointPath : options["resume"];
+    if(ds.checkpointPath.empty())
+        ds.checkpointPath = ds.resumePath;
+}
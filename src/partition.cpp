@@ -0,0 +1,130 @@
+// Jacob Matchuny
+// TSP solver
+// Partition source
+
+// Includes from this project
+#include "partition.h"
+#include "hilbert.h"
+
+// Extern includes
+#include <algorithm>
+#include <cmath>
+
+// Squared distance from id to a point
+static inline float distSq(const std::vector<float>& xs, const std::vector<float>& ys, unsigned int id, float x, float y)
+{
+    float dx = xs[id] - x;
+    float dy = ys[id] - y;
+    return dx * dx + dy * dy;
+}
+
+// Recursive median cuts
+std::vector<std::vector<unsigned int>> partitionCities(const std::vector<float>& xs, const std::vector<float>& ys, unsigned int maxSize)
+{
+    std::vector<std::vector<unsigned int>> boxes(1), clusters;
+    maxSize = std::max(maxSize, 8u);
+    for(unsigned int i = 0; i < xs.size(); i++)
+        boxes[0].push_back(i);
+
+    while(!boxes.empty())
+    {
+        std::vector<unsigned int> box;
+        box.swap(boxes.back());
+        boxes.pop_back();
+
+        if(box.size() <= maxSize)
+        {
+            if(!box.empty())
+                clusters.push_back(std::move(box));
+            continue;
+        }
+
+        // Cut across the longer side at the median
+        float minX = xs[box[0]], maxX = minX, minY = ys[box[0]], maxY = minY;
+        for(unsigned int id : box)
+        {
+            minX = std::min(minX, xs[id]);
+            maxX = std::max(maxX, xs[id]);
+            minY = std::min(minY, ys[id]);
+            maxY = std::max(maxY, ys[id]);
+        }
+
+        const std::vector<float>& axis = maxX - minX >= maxY - minY ? xs : ys;
+        auto middle = box.begin() + box.size() / 2;
+        std::nth_element(box.begin(), middle, box.end(), [&](unsigned int a, unsigned int b) { return axis[a] < axis[b]; });
+
+        boxes.push_back(std::vector<unsigned int>(box.begin(), middle));
+        boxes.push_back(std::vector<unsigned int>(middle, box.end()));
+    }
+
+    // Visit clusters along a Hilbert curve over their centroids
+    std::vector<float> cx(clusters.size(), 0), cy(clusters.size(), 0);
+    for(unsigned int c = 0; c < clusters.size(); c++)
+    {
+        for(unsigned int id : clusters[c])
+        {
+            cx[c] += xs[id];
+            cy[c] += ys[id];
+        }
+        cx[c] /= clusters[c].size();
+        cy[c] /= clusters[c].size();
+    }
+
+    std::vector<std::vector<unsigned int>> ordered;
+    ordered.reserve(clusters.size());
+    for(unsigned int c : hilbertOrder(cx, cy))
+        ordered.push_back(std::move(clusters[c]));
+
+    return ordered;
+}
+
+// Open each cluster tour next to its neighbors and chain them
+std::vector<unsigned int> stitchTours(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<std::vector<unsigned int>>& tours)
+{
+    std::vector<unsigned int> order;
+    unsigned int m = tours.size();
+    if(m == 0)
+        return order;
+
+    std::vector<float> cx(m, 0), cy(m, 0);
+    size_t total = 0;
+    for(unsigned int t = 0; t < m; t++)
+    {
+        for(unsigned int id : tours[t])
+        {
+            cx[t] += xs[id];
+            cy[t] += ys[id];
+        }
+        cx[t] /= std::max((size_t) 1, tours[t].size());
+        cy[t] /= std::max((size_t) 1, tours[t].size());
+        total += tours[t].size();
+    }
+    order.reserve(total);
+
+    for(unsigned int t = 0; t < m; t++)
+    {
+        const std::vector<unsigned int>& tour = tours[t];
+        unsigned int size = tour.size();
+        if(size == 0)
+            continue;
+
+        // Enter nearest the previous exit (the last cluster's centroid for the first)
+        float px = order.empty() ? cx[m - 1] : xs[order.back()];
+        float py = order.empty() ? cy[m - 1] : ys[order.back()];
+        unsigned int entry = 0;
+        for(unsigned int i = 1; i < size; i++)
+            if(distSq(xs, ys, tour[i], px, py) < distSq(xs, ys, tour[entry], px, py))
+                entry = i;
+
+        // Leave from whichever tour neighbor of entry is closer to the next cluster
+        unsigned int following = (t + 1) % m;
+        unsigned int after = tour[(entry + 1) % size];
+        unsigned int before = tour[(entry + size - 1) % size];
+        bool backwards = distSq(xs, ys, after, cx[following], cy[following]) < distSq(xs, ys, before, cx[following], cy[following]);
+
+        for(unsigned int i = 0; i < size; i++)
+            order.push_back(tour[backwards ? (entry + size - i) % size : (entry + i) % size]);
+    }
+
+    return order;
+}
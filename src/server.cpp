@@ -0,0 +1,367 @@
+// Jacob Matchuny
+// TSP solver
+// Server source
+
+// Includes from this project
+#include "server.h"
+
+// Extern includes
+#include <cstring>
+#include <csignal>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Function prototypes
+static int openSocket(const std::string&, sockaddr_un&);
+static bool readRequest(int, std::string&);
+static bool writeAll(int, const std::string&);
+static unsigned int cityLimit(const std::string&);
+
+// Constructor
+ResultCache::ResultCache(unsigned int capacity)
+{
+    this->capacity = capacity;
+}
+
+// Look up key
+bool ResultCache::get(unsigned long long key, CachedResult& result)
+{
+    auto it = index.find(key);
+    if(it == index.end())
+        return false;
+
+    // Move to front (most recently used)
+    entries.splice(entries.begin(), entries, it->second);
+    result = it->second->second;
+    return true;
+}
+
+// Insert key
+void ResultCache::put(unsigned long long key, const CachedResult& result)
+{
+    if(capacity == 0)
+        return;
+
+    auto it = index.find(key);
+    if(it != index.end())
+    {
+        it->second->second = result;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    // Evict least recently used
+    if(entries.size() >= capacity)
+    {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+
+    entries.push_front(std::make_pair(key, result));
+    index[key] = entries.begin();
+}
+
+// Number of cached results
+unsigned int ResultCache::size() const
+{
+    return entries.size();
+}
+
+// Canonical hash (FNV-1a) of coordinates in city number order plus options
+unsigned long long instanceHash(const std::vector<City>& cities, const std::string& algorithm, double budget, int cross, int mutate)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    auto mix = [&hash](const void* data, size_t len)
+    {
+        const unsigned char* bytes = (const unsigned char*) data;
+        for(size_t i = 0; i < len; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    // File order must not matter
+    std::vector<City> sorted = cities;
+    std::sort(sorted.begin(), sorted.end());
+
+    unsigned int n = sorted.size();
+    mix(&n, sizeof(n));
+    for(auto & city : sorted)
+    {
+        mix(&city.num, sizeof(city.num));
+        mix(&city.x, sizeof(city.x));
+        mix(&city.y, sizeof(city.y));
+    }
+
+    mix(algorithm.data(), algorithm.size());
+    mix(&budget, sizeof(budget));
+    mix(&cross, sizeof(cross));
+    mix(&mutate, sizeof(mutate));
+
+    return hash;
+}
+
+// Constructor
+Server::Server(std::string path, unsigned int cacheSize) : cache(cacheSize)
+{
+    this->path = path;
+    this->fd = -1;
+    this->clients = 0;
+}
+
+// Destructor
+Server::~Server()
+{
+    if(fd >= 0)
+    {
+        close(fd);
+        unlink(path.c_str());
+    }
+}
+
+// Accept and answer requests
+void Server::run()
+{
+    sockaddr_un addr;
+
+    // Clients hanging up must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+
+    fd = openSocket(path, addr);
+    if(fd < 0)
+    {
+        std::cout << "Bad socket: " << path << std::endl;
+        return;
+    }
+
+    // Replace stale socket from a previous run
+    unlink(path.c_str());
+    if(bind(fd, (sockaddr*) &addr, sizeof(addr)) < 0 || listen(fd, 16) < 0)
+    {
+        std::cout << "Could not listen on: " << path << std::endl;
+        return;
+    }
+
+    std::cout << "Serving on: " << path << std::endl;
+
+    while(true)
+    {
+        int client = accept(fd, NULL, NULL);
+        if(client < 0)
+            continue;
+
+        if(clients >= maxClients)
+        {
+            writeAll(client, "ERR server busy\n");
+            close(client);
+            continue;
+        }
+
+        clients++;
+        std::thread([this, client]()
+        {
+            serve(client);
+            clients--;
+        }).detach();
+    }
+}
+
+// One connection, timeouts keep a stalled client from holding its thread forever
+void Server::serve(int client)
+{
+    timeval timeout = { clientTimeout, 0 };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string text;
+    if(readRequest(client, text))
+    {
+        std::istringstream request(text);
+        writeAll(client, handle(request));
+    }
+    else
+        writeAll(client, "ERR request timed out\n");
+    close(client);
+}
+
+// Answer one request
+std::string Server::handle(std::istream& request)
+{
+    std::string line, command;
+    std::ostringstream response;
+
+    DataSet ds;
+    std::getline(request, line);
+    std::istringstream header(line);
+    if(!(header >> command >> ds.algorithm >> ds.timeBudget >> ds.cross >> ds.mutate) || command.compare("SOLVE") != 0)
+        return "ERR bad request header\n";
+
+    // Instance body runs up to END
+    std::ostringstream body;
+    while(std::getline(request, line) && line.compare("END") != 0)
+        body << line << '\n';
+
+    std::istringstream instance(body.str());
+    ds.readInData(instance);
+    if(ds.cities.size() < 3)
+        return "ERR need at least 3 cities\n";
+
+    // Too large to answer without running the daemon out of memory or time
+    unsigned int limit = cityLimit(ds.algorithm);
+    if(limit > 0 && ds.cities.size() > limit)
+        return "ERR " + ds.algorithm + " takes at most " + std::to_string(limit) + " cities\n";
+
+    // Keyed on the file's own numbers, which the reply is in
+    std::vector<City> labelled = ds.cities;
+    for(auto & city : labelled)
+        city.num = ds.cityLabel(city.num);
+
+    // Answer from cache if we have solved this before
+    CachedResult result;
+    unsigned long long key = instanceHash(labelled, ds.algorithm, ds.timeBudget, ds.cross, ds.mutate);
+    bool cached;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        cached = cache.get(key, result);
+    }
+
+    if(!cached)
+    {
+        std::lock_guard<std::mutex> solve(solving);
+
+        // Same instance may have been solved while we waited
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            cached = cache.get(key, result);
+        }
+
+        if(!cached)
+        {
+            if(!ds.solve())
+                return "ERR unknown algorithm " + ds.algorithm + "\n";
+
+            result.order.clear();
+            for(auto & link : ds.cheapestTour.tour)
+                result.order.push_back(ds.cityLabel(link.a.num));
+            result.cost = ds.cheapestTour.cost;
+            result.time = ds.elapsed();
+
+            std::lock_guard<std::mutex> guard(lock);
+            cache.put(key, result);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::cout << ds.algorithm << " " << ds.cities.size() << " cities: " << result.cost << (cached ? " (cached)" : "") << std::endl;
+    }
+
+    response << "OK " << result.cost << " " << result.time << " " << (cached ? 1 : 0) << '\n';
+    for(unsigned int i = 0; i < result.order.size(); i++)
+        response << (i ? " " : "") << result.order[i];
+    response << '\n';
+
+    return response.str();
+}
+
+// Send instance to server
+int runClient(std::string path, std::string filename, std::string algorithm, double budget, int cross, int mutate)
+{
+    sockaddr_un addr;
+    std::ifstream file(filename);
+
+    if(!file.good())
+    {
+        std::cout << "Bad file: " << filename << std::endl;
+        return 1;
+    }
+
+    int fd = openSocket(path, addr);
+    if(fd < 0 || connect(fd, (sockaddr*) &addr, sizeof(addr)) < 0)
+    {
+        std::cout << "Could not connect to: " << path << std::endl;
+        return 1;
+    }
+
+    // Header, instance, terminator
+    std::ostringstream request;
+    request << "SOLVE " << algorithm << " " << budget << " " << cross << " " << mutate << '\n';
+    request << file.rdbuf() << '\n' << "END" << '\n';
+
+    if(!writeAll(fd, request.str()))
+    {
+        close(fd);
+        return 1;
+    }
+    shutdown(fd, SHUT_WR);
+
+    // Print everything the server sends back
+    char buffer[4096];
+    ssize_t count;
+    while((count = read(fd, buffer, sizeof(buffer))) > 0)
+        std::cout.write(buffer, count);
+
+    close(fd);
+    return 0;
+}
+
+// Create unix socket and fill its address
+static int openSocket(const std::string& path, sockaddr_un& addr)
+{
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if(path.size() >= sizeof(addr.sun_path))
+        return -1;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    return socket(AF_UNIX, SOCK_STREAM, 0);
+}
+
+// Read request up to the END line or hang up
+static bool readRequest(int fd, std::string& request)
+{
+    char buffer[4096];
+    ssize_t count;
+
+    while((count = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        request.append(buffer, count);
+        if(request.size() >= 5 && request.find("\nEND\n", request.size() - count > 4 ? request.size() - count - 4 : 0) != std::string::npos)
+            return true;
+    }
+
+    // End of stream is a whole request, an error or timeout is not
+    return count == 0;
+}
+
+// Write whole buffer
+static bool writeAll(int fd, const std::string& data)
+{
+    size_t sent = 0;
+    while(sent < data.size())
+    {
+        ssize_t count = write(fd, data.data() + sent, data.size() - sent);
+        if(count <= 0)
+            return false;
+        sent += count;
+    }
+
+    return true;
+}
+
+// Most cities an algorithm may be sent (0 = no limit). Brute is factorial,
+// greedy walks from every start in O(n^2) each and wisdom builds an n x n
+// frequency matrix.
+static unsigned int cityLimit(const std::string& algorithm)
+{
+    if(algorithm.compare("brute") == 0)
+        return 12;
+    if(algorithm.compare("greedy") == 0 || algorithm.compare("wisdom") == 0)
+        return 2000;
+
+    return 0;
+}
@@ -0,0 +1,216 @@
+// Jacob Matchuny
+// TSP solver
+// Spatial grid source
+
+// Includes from this project
+#include "spatialgrid.h"
+
+// Extern includes
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// Constructor
+SpatialGrid::SpatialGrid(const std::vector<float>& xs, const std::vector<float>& ys)
+{
+    this->xs = xs.data();
+    this->ys = ys.data();
+    this->n = xs.size();
+    this->minX = 0;
+    this->minY = 0;
+    this->cellSize = 1;
+    this->cellsX = 1;
+    this->cellsY = 1;
+
+    if(n > 0)
+    {
+        minX = *std::min_element(xs.begin(), xs.end());
+        minY = *std::min_element(ys.begin(), ys.end());
+        float width = std::max(*std::max_element(xs.begin(), xs.end()) - minX, 1e-6f);
+        float height = std::max(*std::max_element(ys.begin(), ys.end()) - minY, 1e-6f);
+
+        // About 2 cities per cell
+        cellSize = std::max(std::sqrt(width * height * 2 / n), 1e-6f);
+        cellsX = std::min((int) (width / cellSize) + 1, 1 << 15);
+        cellsY = std::min((int) (height / cellSize) + 1, 1 << 15);
+        cellSize = std::max(width / (cellsX - 0.5f), height / (cellsY - 0.5f));
+    }
+
+    // Counting sort of ids into cells
+    cellStart.assign((size_t) cellsX * cellsY + 1, 0);
+    for(unsigned int i = 0; i < n; i++)
+        cellStart[(size_t) cellY(ys[i]) * cellsX + cellX(xs[i]) + 1]++;
+    for(size_t c = 1; c < cellStart.size(); c++)
+        cellStart[c] += cellStart[c - 1];
+
+    cellItems.resize(n);
+    std::vector<unsigned int> fill(cellStart.begin(), cellStart.end() - 1);
+    for(unsigned int i = 0; i < n; i++)
+        cellItems[fill[(size_t) cellY(ys[i]) * cellsX + cellX(xs[i])]++] = i;
+
+    reset();
+}
+
+// Default constructor
+SpatialGrid::SpatialGrid()
+{
+    this->xs = NULL;
+    this->ys = NULL;
+    this->n = 0;
+    this->minX = 0;
+    this->minY = 0;
+    this->cellSize = 1;
+    this->cellsX = 0;
+    this->cellsY = 0;
+}
+
+// Cell column
+int SpatialGrid::cellX(float x) const
+{
+    return std::min(std::max((int) ((x - minX) / cellSize), 0), cellsX - 1);
+}
+
+// Cell row
+int SpatialGrid::cellY(float y) const
+{
+    return std::min(std::max((int) ((y - minY) / cellSize), 0), cellsY - 1);
+}
+
+// k nearest to id
+void SpatialGrid::kNearest(unsigned int id, unsigned int k, std::vector<unsigned int>& out) const
+{
+    std::vector<std::pair<float, unsigned int>> found;
+    int cx = cellX(xs[id]), cy = cellY(ys[id]);
+    int maxRing = std::max(cellsX, cellsY);
+
+    out.clear();
+    k = std::min(k, n - 1);
+    if(k == 0)
+        return;
+
+    // Grow rings until the k-th best is closer than anything further out
+    for(int ring = 0; ring <= maxRing; ring++)
+    {
+        for(int y = cy - ring; y <= cy + ring; y++)
+        {
+            if(y < 0 || y >= cellsY)
+                continue;
+
+            // Only the border of the ring is new
+            int step = (y == cy - ring || y == cy + ring) ? 1 : std::max(2 * ring, 1);
+            for(int x = cx - ring; x <= cx + ring; x += step)
+            {
+                if(x < 0 || x >= cellsX)
+                    continue;
+
+                size_t cell = (size_t) y * cellsX + x;
+                for(unsigned int c = cellStart[cell]; c < cellStart[cell + 1]; c++)
+                {
+                    unsigned int other = cellItems[c];
+                    if(other == id)
+                        continue;
+
+                    float dx = xs[other] - xs[id];
+                    float dy = ys[other] - ys[id];
+                    found.push_back(std::make_pair(dx * dx + dy * dy, other));
+                }
+            }
+        }
+
+        // Anything in the next ring is at least ring * cellSize away
+        if(found.size() >= k)
+        {
+            std::nth_element(found.begin(), found.begin() + (k - 1), found.end());
+            float reach = ring * cellSize;
+            if(found[k - 1].first <= reach * reach)
+                break;
+        }
+    }
+
+    std::partial_sort(found.begin(), found.begin() + std::min((size_t) k, found.size()), found.end());
+    for(unsigned int i = 0; i < k && i < found.size(); i++)
+        out.push_back(found[i].second);
+}
+
+// Closest accepted id
+unsigned int SpatialGrid::nearest(float px, float py, const std::function<bool(unsigned int)>& accept) const
+{
+    int cx = cellX(px), cy = cellY(py);
+    int maxRing = std::max(cellsX, cellsY);
+    unsigned int best = n;
+    float bestDist = INFINITY;
+
+    for(int ring = 0; ring <= maxRing; ring++)
+    {
+        // Nothing further out can beat best
+        float reach = (ring - 1) * cellSize;
+        if(best < n && ring > 0 && bestDist <= reach * reach)
+            break;
+
+        for(int y = cy - ring; y <= cy + ring; y++)
+        {
+            if(y < 0 || y >= cellsY)
+                continue;
+
+            int step = (y == cy - ring || y == cy + ring) ? 1 : std::max(2 * ring, 1);
+            for(int x = cx - ring; x <= cx + ring; x += step)
+            {
+                if(x < 0 || x >= cellsX)
+                    continue;
+
+                size_t cell = (size_t) y * cellsX + x;
+                if(alive[cell] == 0)
+                    continue;
+
+                for(unsigned int c = cellStart[cell]; c < cellStart[cell + 1]; c++)
+                {
+                    unsigned int other = cellItems[c];
+                    if(removed[other])
+                        continue;
+
+                    float dx = xs[other] - px;
+                    float dy = ys[other] - py;
+                    float d = dx * dx + dy * dy;
+                    if((d < bestDist || (d == bestDist && other < best)) && accept(other))
+                    {
+                        bestDist = d;
+                        best = other;
+                    }
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+// Closest live id
+unsigned int SpatialGrid::nearest(float px, float py) const
+{
+    return nearest(px, py, [](unsigned int) { return true; });
+}
+
+// Hide id
+void SpatialGrid::remove(unsigned int id)
+{
+    if(removed[id])
+        return;
+
+    removed[id] = true;
+    alive[(size_t) cellY(ys[id]) * cellsX + cellX(xs[id])]--;
+}
+
+// Show every id
+void SpatialGrid::reset()
+{
+    removed.assign(n, false);
+    alive.assign((size_t) cellsX * cellsY, 0);
+    for(size_t cell = 0; cell < alive.size(); cell++)
+        alive[cell] = cellStart[cell + 1] - cellStart[cell];
+}
+
+// Number of ids
+unsigned int SpatialGrid::size() const
+{
+    return n;
+}
@@ -0,0 +1,405 @@
+// Jacob Matchuny
+// TSP solver
+// Tabu search source
+
+// Includes from this project
+#include "tabu.h"
+#include "localsearch.h"
+#include "threadpool.h"
+
+// Extern includes
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+// Smallest gain worth a move
+static const double EPSILON = 1e-6;
+
+// Cities scored per pool task, at most MAX_CHUNKS tasks a step
+static const unsigned int CHUNK = 128;
+static const unsigned int MAX_CHUNKS = 64;
+
+// Steps between stop checks without a new best
+static const unsigned long CHECK_EVERY = 16;
+
+// Constructor
+TabuMemory::TabuMemory(unsigned int expected)
+{
+    unsigned long long size = 16;
+    while(size < 4ULL * expected)
+        size *= 2;
+
+    this->slots.assign(size, Slot { 0, 0 });
+    this->mask = size - 1;
+    this->used = 0;
+}
+
+// Smaller id in the high half, +1 so no edge packs to 0
+unsigned long long TabuMemory::pack(unsigned int a, unsigned int b)
+{
+    if(a > b)
+        std::swap(a, b);
+    return ((unsigned long long) a + 1) << 32 | ((unsigned long long) b + 1);
+}
+
+// Fibonacci hashing
+unsigned long long TabuMemory::home(unsigned long long key) const
+{
+    return ((key * 0x9e3779b97f4a7c15ULL) >> 29) & mask;
+}
+
+// Update the edge's slot, else take the first expired or empty one
+void TabuMemory::forbid(unsigned int a, unsigned int b, unsigned long until, unsigned long now)
+{
+    unsigned long long key = pack(a, b);
+    unsigned long long i = home(key);
+    Slot* free = NULL;
+    for(; slots[i].key != 0; i = (i + 1) & mask)
+    {
+        if(slots[i].key == key)
+        {
+            slots[i].until = until;
+            return;
+        }
+        if(!free && slots[i].until <= now)
+            free = &slots[i];
+    }
+
+    // Reusing an expired slot keeps probe chains intact
+    if(!free)
+    {
+        free = &slots[i];
+        used++;
+    }
+    free->key = key;
+    free->until = until;
+
+    if(2ULL * used > slots.size())
+        rebuild(now);
+}
+
+// Probe until the edge or an empty slot
+bool TabuMemory::forbidden(unsigned int a, unsigned int b, unsigned long now) const
+{
+    unsigned long long key = pack(a, b);
+    for(unsigned long long i = home(key); slots[i].key != 0; i = (i + 1) & mask)
+    {
+        if(slots[i].key == key)
+            return slots[i].until > now;
+    }
+
+    return false;
+}
+
+// Empty every slot
+void TabuMemory::clear()
+{
+    std::fill(slots.begin(), slots.end(), Slot { 0, 0 });
+    used = 0;
+}
+
+// Reinsert live edges, doubling when they alone fill a quarter
+void TabuMemory::rebuild(unsigned long now)
+{
+    std::vector<Slot> live;
+    for(auto & slot : slots)
+    {
+        if(slot.key != 0 && slot.until > now)
+            live.push_back(slot);
+    }
+
+    if(4 * live.size() > slots.size())
+    {
+        slots.resize(slots.size() * 2);
+        mask = slots.size() - 1;
+    }
+    clear();
+
+    for(auto & slot : live)
+    {
+        unsigned long long i = home(slot.key);
+        while(slots[i].key != 0)
+            i = (i + 1) & mask;
+        slots[i] = slot;
+        used++;
+    }
+}
+
+// Constructor
+TabuSearch::TabuSearch(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<unsigned int>& candidates, unsigned int k) : xs(xs), ys(ys), candidates(candidates)
+{
+    this->k = k;
+    this->n = xs.size();
+    this->tenure = 40;
+    this->restartSteps = 0;
+    this->maxSteps = 5000;
+    this->seed = 1;
+    this->steps = 0;
+    this->improvements = 0;
+    this->aspirations = 0;
+    this->restarts = 0;
+    this->startCost = 0;
+    this->descentCost = 0;
+    this->bestCost = 0;
+}
+
+// Distance between ids
+double TabuSearch::dist(unsigned int a, unsigned int b) const
+{
+    double dx = xs[a] - xs[b];
+    double dy = ys[a] - ys[b];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Exact tour length
+double TabuSearch::length(const std::vector<unsigned int>& order) const
+{
+    double sum = 0;
+    for(unsigned int i = 0; i < order.size(); i++)
+        sum += dist(order[i], order[(i + 1) % order.size()]);
+    return sum;
+}
+
+// Descend with local search, then one best admissible move per step
+std::vector<unsigned int> TabuSearch::run(const std::vector<unsigned int>& initial, const std::function<bool(const std::vector<unsigned int>&, float)>& stop)
+{
+    steps = 0;
+    improvements = 0;
+    aspirations = 0;
+    restarts = 0;
+
+    std::vector<unsigned int> best = initial;
+    startCost = length(best);
+
+    // Tabu steps are too costly to spend on plain descent
+    LocalSearch descent(xs, ys, candidates, k);
+    descent.optimize(best);
+    double bestLength = length(best);
+    descentCost = bestCost = bestLength;
+    if(n < 8 || k == 0 || stop(best, bestCost))
+        return best;
+
+    ArrayTour tour(best);
+    TabuMemory memory(6 * 2 * tenure);
+    std::mt19937 rng(seed);
+    double cost = bestLength;
+    unsigned long lastBest = 0;
+    unsigned long patience = restartSteps > 0 ? restartSteps : n;
+
+    ThreadPool& pool = ThreadPool::instance();
+    unsigned int chunks = std::max(1u, std::min(MAX_CHUNKS, n / CHUNK));
+    std::vector<TabuMove> moves(chunks);
+
+    while(maxSteps == 0 || steps < maxSteps)
+    {
+        steps++;
+
+        // Score the neighbourhood in fixed chunks, so the move taken does not
+        // depend on the thread count
+        pool.parallelFor(0, chunks, [&](unsigned int c)
+        {
+            scan(tour, memory, steps, cost, bestLength, (unsigned long) n * c / chunks, (unsigned long) n * (c + 1) / chunks, moves[c]);
+        }, 1);
+
+        TabuMove move = moves[0];
+        for(unsigned int c = 1; c < chunks; c++)
+        {
+            if(moves[c].delta < move.delta)
+                move = moves[c];
+        }
+
+        // Every move tabu, let them all go. Still a step, so it reaches the
+        // stop check below
+        bool found = false;
+        if(move.delta == std::numeric_limits<double>::infinity())
+            memory.clear();
+        else
+        {
+            if(tabu(memory, steps, move))
+                aspirations++;
+            apply(tour, memory, move, steps, rng);
+            cost += move.delta;
+
+            found = cost < bestLength - EPSILON;
+            if(found)
+            {
+                best = tour.sequence();
+                bestLength = cost;
+                bestCost = cost;
+                lastBest = steps;
+                improvements++;
+            }
+            else if(steps - lastBest >= patience)
+            {
+                // Stuck, go back to the best tour and knock it out of its minimum
+                tour = ArrayTour(best);
+                memory.clear();
+                kick(tour, memory, steps, rng);
+                cost = length(tour.sequence());
+                lastBest = steps;
+                restarts++;
+            }
+        }
+
+        if((found || steps % CHECK_EVERY == 0) && stop(best, bestCost))
+            break;
+    }
+
+    bestCost = length(best);
+    return best;
+}
+
+// Both sides of every candidate edge for 2-opt, segments of 1-3 cities
+// starting at each city for or-opt
+void TabuSearch::scan(const ArrayTour& tour, const TabuMemory& memory, unsigned long step, double cost, double bestLength, unsigned int first, unsigned int last, TabuMove& best) const
+{
+    best.delta = std::numeric_limits<double>::infinity();
+    TabuMove move;
+
+    for(unsigned int a = first; a < last; a++)
+    {
+        // 2-opt with a's successor or predecessor
+        move.orOpt = false;
+        move.reversed = false;
+        for(int side = 0; side < 2; side++)
+        {
+            unsigned int b = side == 0 ? tour.next(a) : tour.prev(a);
+            double ab = dist(a, b);
+            for(unsigned int i = 0; i < k; i++)
+            {
+                unsigned int c = candidates[(size_t) a * k + i];
+                if(c >= n)
+                    break;
+
+                unsigned int d = side == 0 ? tour.next(c) : tour.prev(c);
+                if(c == b || d == a)
+                    continue;
+
+                move.delta = dist(a, c) + dist(b, d) - ab - dist(c, d);
+                move.a = a;
+                move.b = b;
+                move.c = c;
+                move.d = d;
+                offer(memory, step, cost, bestLength, move, best);
+            }
+        }
+
+        // Or-opt, same segment checks as LocalSearch::improveOrOpt
+        move.orOpt = true;
+        unsigned int end = a;
+        for(unsigned int size = 1; size <= 3 && size + 2 < n; size++)
+        {
+            if(size > 1)
+                end = tour.next(end);
+
+            unsigned int prev = tour.prev(a);
+            unsigned int next = tour.next(end);
+            double removed = dist(prev, a) + dist(end, next) - dist(prev, next);
+
+            for(unsigned int i = 0; i < k; i++)
+            {
+                unsigned int c = candidates[(size_t) a * k + i];
+                if(c >= n)
+                    break;
+                if(tour.between(a, c, end))
+                    continue;
+
+                // Edge after c, then edge before c
+                for(int side = 0; side < 2; side++)
+                {
+                    unsigned int x = side == 0 ? c : tour.prev(c);
+                    unsigned int y = tour.next(x);
+                    if(x == next || y == prev || tour.between(a, x, end) || tour.between(a, y, end))
+                        continue;
+
+                    double forward = dist(x, a) + dist(end, y);
+                    double reversed = dist(x, end) + dist(a, y);
+                    move.delta = std::min(forward, reversed) - dist(x, y) - removed;
+                    move.reversed = reversed <= forward;
+                    move.a = a;
+                    move.b = end;
+                    move.c = prev;
+                    move.d = next;
+                    move.e = x;
+                    move.f = y;
+                    offer(memory, step, cost, bestLength, move, best);
+                }
+            }
+        }
+    }
+}
+
+// Added edges checked against the memory
+bool TabuSearch::tabu(const TabuMemory& memory, unsigned long step, const TabuMove& move) const
+{
+    if(!move.orOpt)
+        return memory.forbidden(move.a, move.c, step) || memory.forbidden(move.b, move.d, step);
+
+    if(memory.forbidden(move.c, move.d, step))
+        return true;
+    if(move.reversed)
+        return memory.forbidden(move.e, move.b, step) || memory.forbidden(move.a, move.f, step);
+    return memory.forbidden(move.e, move.a, step) || memory.forbidden(move.b, move.f, step);
+}
+
+// Tabu moves only count when they beat the best tour
+void TabuSearch::offer(const TabuMemory& memory, unsigned long step, double cost, double bestLength, const TabuMove& move, TabuMove& best) const
+{
+    if(move.delta >= best.delta)
+        return;
+    if(cost + move.delta >= bestLength - EPSILON && tabu(memory, step, move))
+        return;
+
+    best = move;
+}
+
+// Orientation independent 2-opt
+void TabuSearch::exchange(ArrayTour& tour, unsigned int a, unsigned int b, unsigned int c, unsigned int d) const
+{
+    if(tour.next(a) == b)
+        tour.flip(a, b, c, d);
+    else
+        tour.flip(b, a, d, c);
+}
+
+// Make the move, its removed edges stay out for a random tenure
+void TabuSearch::apply(ArrayTour& tour, TabuMemory& memory, const TabuMove& move, unsigned long step, std::mt19937& rng) const
+{
+    unsigned long until = step + tenure + rng() % std::max(1u, tenure);
+    if(!move.orOpt)
+    {
+        exchange(tour, move.a, move.b, move.c, move.d);
+        memory.forbid(move.a, move.b, until, step);
+        memory.forbid(move.c, move.d, until, step);
+        return;
+    }
+
+    // Three 2-opt moves: cut the segment out reversed between e and f,
+    // close the gap, then turn the segment around unless it goes in reversed
+    exchange(tour, move.c, move.a, move.e, move.f);
+    exchange(tour, move.c, move.e, move.d, move.b);
+    if(!move.reversed)
+        exchange(tour, move.e, move.b, move.a, move.f);
+
+    memory.forbid(move.c, move.a, until, step);
+    memory.forbid(move.b, move.d, until, step);
+    memory.forbid(move.e, move.f, until, step);
+}
+
+// Same stretch reversal as the GA kick
+void TabuSearch::kick(ArrayTour& tour, TabuMemory& memory, unsigned long step, std::mt19937& rng) const
+{
+    unsigned int start = rng() % n;
+    unsigned int end = start;
+    unsigned int size = 2 + rng() % std::min(n - 3, 50u);
+    for(unsigned int i = 1; i < size; i++)
+        end = tour.next(end);
+
+    unsigned int before = tour.prev(start);
+    unsigned int after = tour.next(end);
+    exchange(tour, before, start, end, after);
+
+    unsigned long until = step + 2 * tenure;
+    memory.forbid(before, start, until, step);
+    memory.forbid(end, after, until, step);
+}
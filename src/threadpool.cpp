@@ -0,0 +1,273 @@
+// Jacob Matchuny
+// TSP solver
+// Thread pool source
+
+// Includes from this project
+#include "threadpool.h"
+
+// Extern includes
+#include <algorithm>
+
+// CPU affinity
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Settings for the shared pool
+unsigned int ThreadPool::configuredThreads = 0;
+bool ThreadPool::configuredPin = false;
+
+// Pool and worker index of the running thread (null / 0 outside any pool)
+static thread_local ThreadPool* currentPool = NULL;
+static thread_local unsigned int currentWorker = 0;
+
+// Shared pool
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool pool(configuredThreads, configuredPin);
+    return pool;
+}
+
+// Settings for the shared pool
+void ThreadPool::configure(unsigned int threads, bool pin)
+{
+    configuredThreads = threads;
+    configuredPin = pin;
+}
+
+// Constructor
+ThreadPool::ThreadPool(unsigned int threads, bool pin)
+{
+    this->executed = 0;
+    this->stolen = 0;
+    this->queued = 0;
+    this->halt = false;
+
+    if(threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Caller of forkJoin is the last thread
+    for(unsigned int i = 0; i + 1 < threads; i++)
+        workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    for(unsigned int i = 0; i < workers.size(); i++)
+    {
+        workers[i]->thread = std::thread(&ThreadPool::loop, this, i);
+
+#ifdef __linux__
+        if(pin)
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(i % std::max(1u, std::thread::hardware_concurrency()), &cpus);
+            pthread_setaffinity_np(workers[i]->thread.native_handle(), sizeof(cpus), &cpus);
+        }
+#endif
+    }
+}
+
+// Destructor
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        halt = true;
+    }
+    wake.notify_all();
+
+    for(auto & worker : workers)
+        worker->thread.join();
+}
+
+// Threads including the caller
+unsigned int ThreadPool::size() const
+{
+    return workers.size() + 1;
+}
+
+// Queue task
+void ThreadPool::push(Task task)
+{
+    task.join->queued++;
+    if(currentPool == this)
+    {
+        std::lock_guard<std::mutex> guard(workers[currentWorker]->lock);
+        workers[currentWorker]->tasks.push_back(std::move(task));
+    }
+    else
+    {
+        std::lock_guard<std::mutex> guard(sharedLock);
+        shared.push_back(std::move(task));
+    }
+
+    // Sleepers check queued under sleepLock, taking it here means none misses this wake
+    queued++;
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+    }
+    wake.notify_one();
+}
+
+// Find a task
+bool ThreadPool::take(Task& task, Join* join)
+{
+    if(queued == 0)
+        return false;
+
+    // Newest own task first, it is the one whose data is still in cache
+    if(currentPool == this)
+    {
+        Worker& own = *workers[currentWorker];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if(!own.tasks.empty() && (join == NULL || own.tasks.back().join == join))
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            task.join->queued--;
+            queued--;
+            return true;
+        }
+    }
+
+    // A join only helps with its own tasks, those of an outside caller sit here
+    if(join != NULL)
+        return currentPool != this && takeShared(task, join);
+    if(takeShared(task, NULL))
+        return true;
+
+    // Oldest task of another worker, starting after our own index
+    unsigned int start = currentPool == this ? currentWorker + 1 : 0;
+    for(unsigned int i = 0; i < workers.size(); i++)
+    {
+        Worker& victim = *workers[(start + i) % workers.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if(!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            task.join->queued--;
+            queued--;
+            stolen++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Oldest shared task, or the oldest of one join
+bool ThreadPool::takeShared(Task& task, Join* join)
+{
+    std::lock_guard<std::mutex> guard(sharedLock);
+    for(auto it = shared.begin(); it != shared.end(); ++it)
+    {
+        if(join == NULL || it->join == join)
+        {
+            task = std::move(*it);
+            shared.erase(it);
+            task.join->queued--;
+            queued--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Run and count off
+void ThreadPool::execute(Task& task)
+{
+    task.work();
+    executed++;
+
+    // Last task of a join wakes whoever waits on it
+    if(--task.join->pending == 0)
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        joined.notify_all();
+    }
+}
+
+// Fork, then help until joined
+void ThreadPool::forkJoin(const std::vector<std::function<void()>>& tasks)
+{
+    // Pushed last to first so the caller, taking from the back, starts with the first
+    Join join;
+    join.pending = tasks.size();
+    join.queued = 0;
+    if(currentPool == this)
+        for(unsigned int i = tasks.size(); i > 0; i--)
+            push(Task{ tasks[i - 1], &join });
+    else
+        for(unsigned int i = 0; i < tasks.size(); i++)
+            push(Task{ tasks[i], &join });
+
+    Task task;
+    while(join.pending > 0)
+    {
+        if(take(task, &join))
+        {
+            execute(task);
+            continue;
+        }
+
+        // Nothing of ours left to take, sleep until the rest finish elsewhere.
+        // Tasks of other joins do not wake us, we could not run them anyway
+        std::unique_lock<std::mutex> guard(sleepLock);
+        joined.wait(guard, [&] { return join.pending == 0 || join.queued > 0; });
+    }
+}
+
+// Chunked loop
+void ThreadPool::parallelFor(unsigned int begin, unsigned int end, const std::function<void(unsigned int)>& body, unsigned int grain)
+{
+    if(end <= begin)
+        return;
+
+    unsigned int count = end - begin;
+    if(grain == 0)
+        grain = std::max(1u, count / (4 * size()));
+
+    // One chunk runs inline
+    if(count <= grain || size() == 1)
+    {
+        for(unsigned int i = begin; i < end; i++)
+            body(i);
+        return;
+    }
+
+    std::vector<std::function<void()>> tasks;
+    for(unsigned int first = begin; first < end; first += grain)
+    {
+        unsigned int last = std::min(end, first + grain);
+        tasks.push_back([&body, first, last]()
+        {
+            for(unsigned int i = first; i < last; i++)
+                body(i);
+        });
+    }
+
+    forkJoin(tasks);
+}
+
+// Worker loop
+void ThreadPool::loop(unsigned int index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    Task task;
+    while(true)
+    {
+        if(take(task, NULL))
+        {
+            execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this] { return halt || queued > 0; });
+        if(halt)
+            break;
+    }
+}
@@ -0,0 +1,149 @@
+// Jacob Matchuny
+// TSP solver
+// Tour file source
+
+// Includes from this project
+#include "tourfile.h"
+
+// Extern includes
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+// Read tour numbers
+bool readTour(const std::string& path, std::vector<unsigned int>& tour)
+{
+    std::ifstream file(path);
+    if(!file.good())
+        return false;
+
+    // Skip the header up to TOUR_SECTION, files without one are bare numbers
+    std::string line;
+    bool section = false;
+    while(!section && std::getline(file, line))
+        section = line.find("TOUR_SECTION") != std::string::npos;
+    if(!section)
+    {
+        file.clear();
+        file.seekg(0);
+    }
+
+    tour.clear();
+    long num;
+    while(file >> num && num != -1)
+    {
+        // 0 is a city in files numbered from 0
+        if(num < 0)
+            return false;
+        tour.push_back((unsigned int) num);
+    }
+
+    return !tour.empty();
+}
+
+// Header, one number per line, -1 and EOF
+bool writeTour(const std::string& path, const std::string& name, const std::vector<unsigned int>& tour, double length)
+{
+    char comment[64];
+    std::snprintf(comment, sizeof(comment), "%.2f", length);
+
+    TourWriter out(path);
+    out.text("NAME : " + name + "\n");
+    out.text("COMMENT : Length = " + std::string(comment) + "\n");
+    out.text("TYPE : TOUR\n");
+    out.text("DIMENSION : " + std::to_string(tour.size()) + "\n");
+    out.text("TOUR_SECTION\n");
+    for(unsigned int num : tour)
+        out.line(num);
+    out.line(-1);
+    out.text("EOF\n");
+
+    return out.close();
+}
+
+// Constructor
+TourWriter::TourWriter(const std::string& path)
+{
+    this->file = std::fopen(path.c_str(), "wb");
+    this->used = 0;
+    this->failed = file == NULL;
+}
+
+// Destructor
+TourWriter::~TourWriter()
+{
+    close();
+}
+
+// Text as bytes
+void TourWriter::text(const std::string& value)
+{
+    bytes(value.data(), value.size());
+}
+
+// Copy bytes in, flushing as the buffer fills
+void TourWriter::bytes(const void* data, size_t size)
+{
+    const char* from = (const char*) data;
+    size_t done = 0;
+    while(done < size)
+    {
+        if(used == sizeof(buffer))
+            flush();
+
+        size_t count = std::min(size - done, sizeof(buffer) - used);
+        std::memcpy(buffer + used, from + done, count);
+        used += count;
+        done += count;
+    }
+}
+
+// Number ended by a newline
+void TourWriter::line(long value)
+{
+    number(value, '\n');
+}
+
+// Digits backwards into scratch, then forwards into the buffer
+void TourWriter::number(long value, char separator)
+{
+    char digits[24];
+    int count = 0;
+    unsigned long magnitude = value < 0 ? 0UL - (unsigned long) value : (unsigned long) value;
+    do
+    {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    }
+    while(magnitude > 0);
+    if(value < 0)
+        digits[count++] = '-';
+
+    if(used + count + 1 > sizeof(buffer))
+        flush();
+    while(count > 0)
+        buffer[used++] = digits[--count];
+    buffer[used++] = separator;
+}
+
+// Pending bytes to disk
+void TourWriter::flush()
+{
+    if(file && used > 0 && std::fwrite(buffer, 1, used, file) != used)
+        failed = true;
+    used = 0;
+}
+
+// Close once
+bool TourWriter::close()
+{
+    if(file)
+    {
+        flush();
+        if(std::fclose(file) != 0)
+            failed = true;
+        file = NULL;
+    }
+
+    return !failed;
+}
@@ -0,0 +1,295 @@
+// Jacob Matchuny
+// TSP solver
+// Trace source
+
+// Includes from this project
+#include "trace.h"
+
+// Extern includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+
+// Records go to disk as is, keep the layout fixed
+static_assert(sizeof(TraceRecord) == 56, "TraceRecord layout changed");
+
+// Binary trace magic, bump the digit when TraceRecord changes
+static const char MAGIC[8] = { '\x89', 'T', 'S', 'P', 'T', 'R', 'C', '1' };
+
+// Records buffered before the writer gets them
+static const unsigned int BLOCK = 256;
+
+// CSV columns
+static const char* HEADER = "run,generation,time_ms,best,mean,worst,distinct,population,cross_tried,cross_accepted,mutate_tried,mutate_accepted\n";
+
+// Paths ending in .csv are text
+static bool csvPath(const std::string& path)
+{
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+}
+
+// Constructor
+TraceSink::TraceSink(const std::string& path)
+{
+    this->file = std::fopen(path.c_str(), "wb");
+    this->csv = csvPath(path);
+    this->failed = file == NULL;
+    this->recorded = 0;
+    this->busy = false;
+    this->halt = false;
+    this->buffer.reserve(BLOCK);
+
+    if(file)
+    {
+        if(csv)
+            failed = std::fputs(HEADER, file) < 0;
+        else
+            failed = std::fwrite(MAGIC, 1, sizeof(MAGIC), file) != sizeof(MAGIC);
+    }
+
+    this->worker = std::thread(&TraceSink::run, this);
+}
+
+// Destructor
+TraceSink::~TraceSink()
+{
+    post();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        halt = true;
+    }
+    wake.notify_one();
+    worker.join();
+
+    if(file)
+        std::fclose(file);
+}
+
+// Buffer, posting full blocks
+void TraceSink::record(const TraceRecord& sample)
+{
+    buffer.push_back(sample);
+    recorded++;
+    if(buffer.size() >= BLOCK)
+        post();
+}
+
+// Move the buffer to the writer's queue
+void TraceSink::post()
+{
+    if(buffer.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        pending.push_back(std::move(buffer));
+    }
+    wake.notify_one();
+
+    buffer.clear();
+    buffer.reserve(BLOCK);
+}
+
+// Post and wait for the writer to go idle
+void TraceSink::flush()
+{
+    post();
+
+    std::unique_lock<std::mutex> guard(lock);
+    idle.wait(guard, [this] { return pending.empty() && !busy; });
+    if(file && std::fflush(file) != 0)
+        failed = true;
+}
+
+// Writer state
+bool TraceSink::good()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return !failed;
+}
+
+// Write blocks until halted
+void TraceSink::run()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    while(true)
+    {
+        wake.wait(guard, [this] { return !pending.empty() || halt; });
+        if(pending.empty())
+            break;
+
+        // Write outside the lock so record never waits on the disk
+        std::vector<std::vector<TraceRecord>> blocks;
+        std::swap(blocks, pending);
+        busy = true;
+        guard.unlock();
+
+        for(auto & block : blocks)
+            write(block);
+
+        guard.lock();
+        busy = false;
+        idle.notify_all();
+    }
+}
+
+// One block out
+void TraceSink::write(const std::vector<TraceRecord>& block)
+{
+    if(!file)
+        return;
+
+    bool ok = true;
+    if(csv)
+    {
+        for(auto & r : block)
+            ok &= std::fprintf(file, "%u,%u,%.3f,%.3f,%.3f,%.3f,%u,%u,%u,%u,%u,%u\n", r.run, r.generation, r.time, r.best, r.mean, r.worst,
+                    r.distinct, r.population, r.crossTried, r.crossAccepted, r.mutateTried, r.mutateAccepted) > 0;
+    }
+    else
+        ok = std::fwrite(block.data(), sizeof(TraceRecord), block.size(), file) == block.size();
+
+    if(!ok)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        failed = true;
+    }
+}
+
+// Binary by magic, CSV otherwise
+bool readTrace(const std::string& path, std::vector<TraceRecord>& records)
+{
+    std::ifstream in(path, std::ios::binary);
+    if(!in.good())
+        return false;
+
+    records.clear();
+    char magic[sizeof(MAGIC)];
+    if(in.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), MAGIC))
+    {
+        TraceRecord r;
+        while(in.read((char*) &r, sizeof(r)))
+            records.push_back(r);
+        return in.gcount() == 0;
+    }
+
+    // Header line, then twelve comma separated values a line
+    in.clear();
+    in.seekg(0);
+    std::string line;
+    std::getline(in, line);
+    while(std::getline(in, line))
+    {
+        TraceRecord r;
+        if(std::sscanf(line.c_str(), "%u,%u,%lf,%f,%f,%f,%u,%u,%u,%u,%u,%u", &r.run, &r.generation, &r.time, &r.best, &r.mean, &r.worst,
+                    &r.distinct, &r.population, &r.crossTried, &r.crossAccepted, &r.mutateTried, &r.mutateAccepted) != 12)
+            return false;
+        records.push_back(r);
+    }
+
+    return true;
+}
+
+// TraceSummary - time to target of one file
+struct TraceSummary
+{
+    std::string path;
+    unsigned int runs, reached;
+    double median, fastest;
+    float final;
+};
+
+// Per run and per file times to target, then the ranking
+int summarizeTraces(const std::vector<std::string>& paths, double target)
+{
+    std::vector<std::vector<TraceRecord>> traces(paths.size());
+    for(unsigned int f = 0; f < paths.size(); f++)
+    {
+        if(!readTrace(paths[f], traces[f]))
+        {
+            std::cout << "Bad trace: " << paths[f] << std::endl;
+            return 1;
+        }
+    }
+
+    // No target given, use the cheapest cost any run reached
+    if(target <= 0)
+    {
+        target = 1e30;
+        for(auto & trace : traces)
+            for(auto & r : trace)
+                target = std::min(target, (double) r.best);
+    }
+    std::cout << "Target: " << target << std::endl;
+
+    std::vector<TraceSummary> summaries;
+    for(unsigned int f = 0; f < paths.size(); f++)
+    {
+        // First sample at or under target and last best of each run
+        std::map<unsigned int, const TraceRecord*> hit, last;
+        for(auto & r : traces[f])
+        {
+            if(r.best <= target && !hit.count(r.run))
+                hit[r.run] = &r;
+            last[r.run] = &r;
+        }
+
+        TraceSummary summary;
+        summary.path = paths[f];
+        summary.runs = last.size();
+        summary.reached = hit.size();
+        summary.final = 0;
+        std::vector<double> times;
+
+        std::cout << std::endl << paths[f] << std::endl;
+        for(auto & run : last)
+        {
+            std::cout << "  Run " << run.first + 1 << ": ";
+            if(hit.count(run.first))
+            {
+                std::cout << hit[run.first]->time << " ms (generation " << hit[run.first]->generation << ")";
+                times.push_back(hit[run.first]->time);
+            }
+            else
+                std::cout << "not reached";
+            std::cout << ", final " << run.second->best << std::endl;
+
+            if(summary.final == 0 || run.second->best < summary.final)
+                summary.final = run.second->best;
+        }
+
+        std::sort(times.begin(), times.end());
+        summary.median = times.empty() ? 0 : times[times.size() / 2];
+        summary.fastest = times.empty() ? 0 : times[0];
+        std::cout << "  Reached " << summary.reached << " / " << summary.runs << " runs";
+        if(!times.empty())
+            std::cout << ", median " << summary.median << " ms, fastest " << summary.fastest << " ms";
+        std::cout << ", cheapest final " << summary.final << std::endl;
+
+        summaries.push_back(summary);
+    }
+
+    // Most runs reaching the target first, then the lowest median
+    if(summaries.size() > 1)
+    {
+        std::sort(summaries.begin(), summaries.end(), [](const TraceSummary& a, const TraceSummary& b)
+        {
+            double shareA = a.runs ? (double) a.reached / a.runs : 0;
+            double shareB = b.runs ? (double) b.reached / b.runs : 0;
+            return shareA != shareB ? shareA > shareB : a.median < b.median;
+        });
+
+        std::cout << std::endl << "Fastest to target:" << std::endl;
+        for(unsigned int i = 0; i < summaries.size(); i++)
+        {
+            std::cout << "  " << i + 1 << ". " << summaries[i].path << " (" << summaries[i].reached << " / " << summaries[i].runs << " runs";
+            if(summaries[i].reached > 0)
+                std::cout << ", median " << summaries[i].median << " ms";
+            std::cout << ")" << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,210 @@
+// Jacob Matchuny
+// TSP solver
+// Two-level tour source
+
+// Includes from this project
+#include "twoleveltour.h"
+
+// Extern includes
+#include <algorithm>
+#include <cmath>
+
+// Constructor
+TwoLevelTour::TwoLevelTour(const std::vector<unsigned int>& order)
+{
+    build(order);
+}
+
+// Fresh segments of about sqrt(n) cities
+void TwoLevelTour::build(const std::vector<unsigned int>& tour)
+{
+    n = tour.size();
+    unsigned int length = std::max(1u, (unsigned int) std::sqrt((double) n));
+    unsigned int count = (n + length - 1) / length;
+
+    segments.assign(count, Segment());
+    order.resize(count);
+    seg.resize(n);
+    idx.resize(n);
+    for(unsigned int s = 0; s < count; s++)
+    {
+        Segment& segment = segments[s];
+        segment.items.assign(tour.begin() + s * length, tour.begin() + std::min(n, (s + 1) * length));
+        segment.reversed = false;
+        order[s] = s;
+
+        for(unsigned int i = 0; i < segment.items.size(); i++)
+        {
+            seg[segment.items[i]] = s;
+            idx[segment.items[i]] = i;
+        }
+    }
+
+    built = count;
+    renumber(0);
+}
+
+// Successor, stepping into the next segment at the end of this one
+unsigned int TwoLevelTour::next(unsigned int id) const
+{
+    const Segment& segment = segments[seg[id]];
+    unsigned int i = idx[id];
+    if(!segment.reversed && i + 1 < segment.items.size())
+        return segment.items[i + 1];
+    if(segment.reversed && i > 0)
+        return segment.items[i - 1];
+
+    const Segment& after = segments[order[segment.rank + 1 == order.size() ? 0 : segment.rank + 1]];
+    return after.reversed ? after.items.back() : after.items.front();
+}
+
+// Predecessor
+unsigned int TwoLevelTour::prev(unsigned int id) const
+{
+    const Segment& segment = segments[seg[id]];
+    unsigned int i = idx[id];
+    if(!segment.reversed && i > 0)
+        return segment.items[i - 1];
+    if(segment.reversed && i + 1 < segment.items.size())
+        return segment.items[i + 1];
+
+    const Segment& before = segments[order[segment.rank == 0 ? order.size() - 1 : segment.rank - 1]];
+    return before.reversed ? before.items.front() : before.items.back();
+}
+
+// Offset in tour direction
+unsigned int TwoLevelTour::offset(unsigned int id) const
+{
+    const Segment& segment = segments[seg[id]];
+    return segment.reversed ? segment.items.size() - 1 - idx[id] : idx[id];
+}
+
+// Tour position
+unsigned int TwoLevelTour::position(unsigned int id) const
+{
+    return start[segments[seg[id]].rank] + offset(id);
+}
+
+// b on path a -> c
+bool TwoLevelTour::between(unsigned int a, unsigned int b, unsigned int c) const
+{
+    unsigned int pa = position(a);
+    return (position(b) + n - pa) % n <= (position(c) + n - pa) % n;
+}
+
+// 2-opt move
+void TwoLevelTour::flip(unsigned int a, unsigned int b, unsigned int c, unsigned int d)
+{
+    // Path b..c or its complement d..a inside one segment
+    if(seg[b] == seg[c] && offset(b) <= offset(c))
+    {
+        reverseInside(b, c);
+        return;
+    }
+    if(seg[d] == seg[a] && offset(d) <= offset(a))
+    {
+        reverseInside(d, a);
+        return;
+    }
+
+    // Cut so b starts and c ends a run of whole segments
+    splitBefore(b);
+    splitBefore(d);
+
+    // Reverse the run, or the complement when the run wraps past rank 0
+    unsigned int rb = segments[seg[b]].rank;
+    unsigned int rc = segments[seg[c]].rank;
+    if(rb <= rc)
+        reverseRanks(rb, rc);
+    else if(rc + 1 < rb)
+        reverseRanks(rc + 1, rb - 1);
+
+    if(order.size() > 2 * built)
+        build(sequence());
+}
+
+// Reverse a stretch of one segment's items
+void TwoLevelTour::reverseInside(unsigned int u, unsigned int v)
+{
+    Segment& segment = segments[seg[u]];
+    unsigned int lo = std::min(idx[u], idx[v]);
+    unsigned int hi = std::max(idx[u], idx[v]);
+
+    std::reverse(segment.items.begin() + lo, segment.items.begin() + hi + 1);
+    for(unsigned int i = lo; i <= hi; i++)
+        idx[segment.items[i]] = i;
+}
+
+// Split the cities before id off into a segment of their own
+void TwoLevelTour::splitBefore(unsigned int id)
+{
+    if(offset(id) == 0)
+        return;
+
+    // The items tail becomes a new segment, after this one or before it if reversed
+    unsigned int s = seg[id];
+    bool reversed = segments[s].reversed;
+    unsigned int rank = segments[s].rank;
+    unsigned int cut = reversed ? idx[id] + 1 : idx[id];
+
+    Segment tail;
+    tail.items.assign(segments[s].items.begin() + cut, segments[s].items.end());
+    tail.reversed = reversed;
+    tail.rank = rank;
+    segments[s].items.resize(cut);
+
+    unsigned int t = segments.size();
+    for(unsigned int i = 0; i < tail.items.size(); i++)
+    {
+        seg[tail.items[i]] = t;
+        idx[tail.items[i]] = i;
+    }
+    segments.push_back(std::move(tail));
+
+    order.insert(order.begin() + (reversed ? rank : rank + 1), t);
+    renumber(rank);
+}
+
+// Reverse a run of segments
+void TwoLevelTour::reverseRanks(unsigned int i, unsigned int j)
+{
+    std::reverse(order.begin() + i, order.begin() + j + 1);
+    for(unsigned int r = i; r <= j; r++)
+        segments[order[r]].reversed = !segments[order[r]].reversed;
+
+    renumber(i);
+}
+
+// Ranks and starts
+void TwoLevelTour::renumber(unsigned int from)
+{
+    start.resize(order.size());
+    for(unsigned int r = from; r < order.size(); r++)
+    {
+        segments[order[r]].rank = r;
+        start[r] = r == 0 ? 0 : start[r - 1] + segments[order[r - 1]].items.size();
+    }
+}
+
+// Tour order
+std::vector<unsigned int> TwoLevelTour::sequence() const
+{
+    std::vector<unsigned int> tour;
+    tour.reserve(n);
+    for(unsigned int s : order)
+    {
+        const Segment& segment = segments[s];
+        if(segment.reversed)
+            tour.insert(tour.end(), segment.items.rbegin(), segment.items.rend());
+        else
+            tour.insert(tour.end(), segment.items.begin(), segment.items.end());
+    }
+
+    return tour;
+}
+
+// City count
+unsigned int TwoLevelTour::size() const
+{
+    return n;
+}